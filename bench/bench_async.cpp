@@ -0,0 +1,178 @@
+#include "audx_async.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/*
+ * Coroutine front end benchmark.
+ *
+ * One event-loop thread runs every stream as a detached_task that awaits its
+ * frames on an AudxPool. Pool workers post finished frames back to the loop,
+ * which resumes the coroutines one at a time, so the loop is the only thread
+ * touching stream bookkeeping. Each stream keeps one frame in flight and
+ * submits the next as soon as it resumes.
+ *
+ * Reports aggregate realtime factor and p50/p99 latency from submit to resume,
+ * and fails if any frame is lost or reports an error.
+ */
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+class event_loop {
+public:
+  void post(std::coroutine_handle<> handle) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.push_back(handle);
+    }
+    cv_.notify_one();
+  }
+
+  // Resume posted coroutines until `live` drops to zero.
+  void run(const std::size_t &live) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (live > 0) {
+      cv_.wait(lock, [this] { return !ready_.empty(); });
+      std::deque<std::coroutine_handle<>> batch;
+      batch.swap(ready_);
+      lock.unlock();
+      for (auto handle : batch)
+        handle.resume();
+      lock.lock();
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::coroutine_handle<>> ready_;
+};
+
+// Executor handle; copied once per completed frame.
+struct loop_executor {
+  event_loop *loop;
+  void post(std::coroutine_handle<> handle) const { loop->post(handle); }
+};
+
+struct bench_stream {
+  AudxState *state = nullptr;
+  std::vector<short> out;
+  std::size_t completed = 0;
+  bool failed = false;
+};
+
+struct bench_run {
+  const std::vector<short> *input;
+  unsigned int in_len;
+  std::size_t frames;
+  std::size_t live;
+  std::vector<float> latency_us;
+};
+
+audx::detached_task stream_main(audx::async_denoiser<loop_executor> den,
+                                bench_stream &stream, bench_run &run) {
+  for (std::size_t f = 0; f < run.frames; f++) {
+    std::span<const short> in(run.input->data() + f * run.in_len, run.in_len);
+
+    auto t0 = clock_type::now();
+    float vad = co_await den.process(in, std::span<short>(stream.out));
+    auto elapsed = clock_type::now() - t0;
+
+    run.latency_us.push_back(
+        std::chrono::duration<float, std::micro>(elapsed).count());
+    if (vad < 0.0f)
+      stream.failed = true;
+    stream.completed++;
+  }
+  run.live--;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int sample_rate = argc > 1 ? atoi(argv[1]) : 16000;
+  std::size_t streams = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000;
+  std::size_t frames = argc > 3 ? strtoul(argv[3], nullptr, 10) : 100;
+  unsigned int workers = argc > 4 ? atoi(argv[4]) : 4;
+
+  unsigned int in_len = calculate_frame_sample(sample_rate);
+  if (in_len == 0 || streams == 0 || frames == 0 || workers == 0) {
+    fprintf(stderr,
+            "Usage: %s [sample rate] [streams] [frames per stream] "
+            "[pool workers]\n",
+            argv[0]);
+    return 1;
+  }
+
+  // All streams read the same white noise; state is per stream regardless.
+  std::vector<short> input(in_len * frames);
+  uint32_t seed = 0x12345678u;
+  for (short &sample : input) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = (short)(((int32_t)(seed >> 16) - 32768) / 8);
+  }
+
+  std::vector<bench_stream> states(streams);
+  for (bench_stream &stream : states) {
+    stream.state = audx_create(nullptr, sample_rate, 4);
+    stream.out.resize(in_len);
+    if (!stream.state) {
+      fprintf(stderr, "Failed to create %zu streams\n", streams);
+      return 1;
+    }
+  }
+
+  AudxPool *pool = audx_pool_create(workers);
+  if (!pool) {
+    fprintf(stderr, "Failed to start a pool of %u workers\n", workers);
+    return 1;
+  }
+
+  event_loop loop;
+  bench_run run = {&input, in_len, frames, streams, {}};
+  run.latency_us.reserve(streams * frames);
+
+  // Streams are started from the loop thread too, before it blocks.
+  auto t0 = clock_type::now();
+  for (bench_stream &stream : states)
+    stream_main(audx::async_denoiser<loop_executor>(pool, stream.state,
+                                                    loop_executor{&loop}),
+                stream, run);
+  loop.run(run.live);
+  double wall_s =
+      std::chrono::duration<double>(clock_type::now() - t0).count();
+
+  audx_pool_destroy(pool);
+
+  std::size_t completed = 0;
+  bool failed = false;
+  for (bench_stream &stream : states) {
+    completed += stream.completed;
+    failed |= stream.failed;
+    audx_destroy(stream.state);
+  }
+
+  if (failed || completed != streams * frames) {
+    fprintf(stderr, "Lost or failed frames: %zu of %zu completed\n",
+            completed, streams * frames);
+    return 1;
+  }
+
+  std::sort(run.latency_us.begin(), run.latency_us.end());
+  float p50 = run.latency_us[completed / 2];
+  float p99 = run.latency_us[(std::size_t)(completed * 0.99)];
+  double rtf = completed * 0.01 / wall_s;
+
+  printf("streams,workers,frames,wall_s,aggregate_rtf,p50_us,p99_us\n");
+  printf("%zu,%u,%zu,%.3f,%.1f,%.1f,%.1f\n", streams, workers, frames, wall_s,
+         rtf, p50, p99);
+  return 0;
+}
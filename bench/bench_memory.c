@@ -0,0 +1,214 @@
+#include "audx.h"
+#include "audx_time.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Memory footprint benchmark.
+ *
+ * Creates 1..N AudxState instances per (sample rate, resample quality) and
+ * reports RSS growth, allocation counts and bytes, and create/destroy time
+ * per stream. Allocation counts come from interposing the malloc family in
+ * this executable (glibc only, and not under AddressSanitizer, which owns the
+ * malloc family); elsewhere only RSS and timings are reported.
+ */
+
+static atomic_size_t alloc_calls;
+static atomic_size_t alloc_bytes;
+static atomic_size_t free_calls;
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define BENCH_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BENCH_ASAN 1
+#endif
+#endif
+
+#if defined(__GLIBC__) && !defined(BENCH_ASAN)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+#define HAVE_ALLOC_HOOKS 1
+
+static inline void count_alloc(size_t size) {
+  atomic_fetch_add_explicit(&alloc_calls, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&alloc_bytes, size, memory_order_relaxed);
+}
+
+void *malloc(size_t size) {
+  count_alloc(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+  count_alloc(nmemb * size);
+  return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  count_alloc(size);
+  return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size) {
+  count_alloc(size);
+  void *ptr = __libc_memalign(alignment, size);
+  if (!ptr)
+    return ENOMEM;
+  *memptr = ptr;
+  return 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  count_alloc(size);
+  return __libc_memalign(alignment, size);
+}
+
+void free(void *ptr) {
+  if (ptr)
+    atomic_fetch_add_explicit(&free_calls, 1, memory_order_relaxed);
+  __libc_free(ptr);
+}
+#else
+#define HAVE_ALLOC_HOOKS 0
+#endif
+
+static long read_rss_kb(void) {
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (!f)
+    return -1;
+
+  long size = 0, resident = 0;
+  int n = fscanf(f, "%ld %ld", &size, &resident);
+  fclose(f);
+  if (n != 2)
+    return -1;
+
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void trim_heap(void) {
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
+
+typedef struct Row {
+  long rss_create_kb;
+  long rss_touch_kb;
+  size_t allocs;
+  size_t bytes;
+  uint64_t create_ns;
+  uint64_t destroy_ns;
+} Row;
+
+static bool measure(unsigned int rate, int quality, size_t count, Row *row) {
+  AudxState **states = calloc(count, sizeof(AudxState *));
+  if (!states)
+    return false;
+
+  unsigned int in_len = calculate_frame_sample(rate);
+  short *frame = calloc(in_len, sizeof(short));
+  short *out = calloc(in_len, sizeof(short));
+  if (!frame || !out) {
+    free(states);
+    free(frame);
+    free(out);
+    return false;
+  }
+
+  trim_heap();
+  long rss0 = read_rss_kb();
+  size_t calls0 = atomic_load(&alloc_calls);
+  size_t bytes0 = atomic_load(&alloc_bytes);
+
+  uint64_t t0 = audx_now_ns();
+  for (size_t i = 0; i < count; i++) {
+    states[i] = audx_create(NULL, rate, quality);
+    if (!states[i]) {
+      fprintf(stderr, "audx_create failed at stream %zu\n", i);
+      count = i;
+      break;
+    }
+  }
+  uint64_t t1 = audx_now_ns();
+
+  row->allocs = atomic_load(&alloc_calls) - calls0;
+  row->bytes = atomic_load(&alloc_bytes) - bytes0;
+  row->create_ns = t1 - t0;
+  row->rss_create_kb = read_rss_kb() - rss0;
+
+  // One frame per stream touches every lazily-faulted page.
+  for (size_t i = 0; i < count; i++)
+    audx_process_int(states[i], frame, out);
+  row->rss_touch_kb = read_rss_kb() - rss0;
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < count; i++)
+    audx_destroy(states[i]);
+  row->destroy_ns = audx_now_ns() - t0;
+
+  free(states);
+  free(frame);
+  free(out);
+  return count > 0;
+}
+
+int main(int argc, char **argv) {
+  size_t max_streams = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+  if (max_streams == 0) {
+    fprintf(stderr, "Usage: %s [max streams]\n", argv[0]);
+    return 1;
+  }
+
+  const unsigned int rates[] = {8000, 16000, 44100, 48000};
+  const int qualities[] = {0, 4, 8, 10};
+
+  // Discarded run so one-time library and stdio setup is not attributed to
+  // the first configuration.
+  Row warmup;
+  measure(16000, 4, 1, &warmup);
+
+  if (!HAVE_ALLOC_HOOKS)
+    printf("malloc interposition unavailable, allocation columns are 0\n");
+
+  for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+    for (size_t q = 0; q < sizeof(qualities) / sizeof(qualities[0]); q++) {
+      // Quality only matters when resampling.
+      if (rates[r] == FRAME_RATE && q > 0)
+        continue;
+
+      printf("\nrate=%u quality=%d\n", rates[r], qualities[q]);
+      printf("%8s %14s %14s %10s %14s %12s %12s\n", "streams", "rss_kb/strm",
+             "touched_kb/st", "allocs/st", "bytes/stream", "create_us",
+             "destroy_us");
+
+      for (size_t n = 1; n <= max_streams; n *= 2) {
+        Row row;
+        if (!measure(rates[r], qualities[q], n, &row))
+          return 1;
+
+        double d = (double)n;
+        printf("%8zu %14.1f %14.1f %10.1f %14.0f %12.1f %12.1f\n", n,
+               row.rss_create_kb / d, row.rss_touch_kb / d, row.allocs / d,
+               row.bytes / d, row.create_ns / d / 1e3,
+               row.destroy_ns / d / 1e3);
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+#ifndef BENCH_PERF_H
+#define BENCH_PERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Hardware counters read around each benchmark stage.
+ *
+ * Counters are opened individually so that a CPU or kernel that lacks one
+ * event (common in VMs and containers) still reports the rest. L2 misses have
+ * no generic perf event, so only L1D and last-level misses are counted.
+ */
+typedef enum BenchCounter {
+  BENCH_CYCLES = 0,
+  BENCH_INSTRUCTIONS,
+  BENCH_L1D_MISSES,
+  BENCH_LLC_MISSES,
+  BENCH_BRANCH_MISSES,
+  BENCH_COUNTER_COUNT
+} BenchCounter;
+
+static const char *bench_counter_names[BENCH_COUNTER_COUNT] = {
+    "cycles", "instructions", "l1d-misses", "llc-misses", "branch-misses",
+};
+
+typedef struct BenchPerf {
+  int fd[BENCH_COUNTER_COUNT];
+  bool available;
+} BenchPerf;
+
+typedef struct BenchSample {
+  uint64_t value[BENCH_COUNTER_COUNT];
+} BenchSample;
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int bench_perf_open_one(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Open all counters for the calling thread.
+ *
+ * @return true if at least one counter is available.
+ */
+static bool bench_perf_open(BenchPerf *perf) {
+  const uint64_t l1d_read_miss =
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  perf->fd[BENCH_CYCLES] =
+      bench_perf_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  perf->fd[BENCH_INSTRUCTIONS] =
+      bench_perf_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  perf->fd[BENCH_L1D_MISSES] =
+      bench_perf_open_one(PERF_TYPE_HW_CACHE, l1d_read_miss);
+  perf->fd[BENCH_LLC_MISSES] =
+      bench_perf_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  perf->fd[BENCH_BRANCH_MISSES] =
+      bench_perf_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+  perf->available = false;
+  for (int i = 0; i < BENCH_COUNTER_COUNT; i++)
+    if (perf->fd[i] >= 0)
+      perf->available = true;
+  return perf->available;
+}
+
+static void bench_perf_read(const BenchPerf *perf, BenchSample *sample) {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+    uint64_t value = 0;
+    if (perf->fd[i] < 0 || read(perf->fd[i], &value, sizeof(value)) !=
+                               (ssize_t)sizeof(value))
+      value = 0;
+    sample->value[i] = value;
+  }
+}
+
+static void bench_perf_close(BenchPerf *perf) {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+    if (perf->fd[i] >= 0)
+      close(perf->fd[i]);
+    perf->fd[i] = -1;
+  }
+  perf->available = false;
+}
+
+#else
+
+static bool bench_perf_open(BenchPerf *perf) {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; i++)
+    perf->fd[i] = -1;
+  perf->available = false;
+  return false;
+}
+
+static void bench_perf_read(const BenchPerf *perf, BenchSample *sample) {
+  (void)perf;
+  memset(sample, 0, sizeof(*sample));
+}
+
+static void bench_perf_close(BenchPerf *perf) { (void)perf; }
+
+#endif // __linux__
+
+static inline bool bench_perf_has(const BenchPerf *perf, BenchCounter c) {
+  return perf->fd[c] >= 0;
+}
+
+#endif // BENCH_PERF_H
@@ -0,0 +1,212 @@
+#include "audx.h"
+#include "audx_denoise.h"
+#include "audx_resampler.h"
+#include "audx_time.h"
+#include "bench_perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Per-stage benchmark of the 10ms pipeline.
+ *
+ * Runs the same stages as audx_process_int() (int16 -> float, upsample,
+ * denoise, downsample, float -> int16) by calling the component APIs
+ * directly, so each stage can be measured with wall-clock time and hardware
+ * counters in isolation.
+ */
+
+typedef enum BenchStage {
+  STAGE_CONVERT_IN = 0,
+  STAGE_UPSAMPLE,
+  STAGE_DENOISE,
+  STAGE_DOWNSAMPLE,
+  STAGE_CONVERT_OUT,
+  STAGE_COUNT
+} BenchStage;
+
+static const char *stage_names[STAGE_COUNT] = {
+    "convert_in", "upsample", "denoise", "downsample", "convert_out",
+};
+
+typedef struct StageStats {
+  uint64_t ns;
+  uint64_t counter[BENCH_COUNTER_COUNT];
+} StageStats;
+
+static BenchPerf perf;
+static StageStats stats[STAGE_COUNT];
+
+static inline void stage_begin(BenchSample *sample, uint64_t *t0) {
+  bench_perf_read(&perf, sample);
+  *t0 = audx_now_ns();
+}
+
+static inline void stage_end(BenchStage stage, const BenchSample *begin,
+                             uint64_t t0) {
+  uint64_t t1 = audx_now_ns();
+  BenchSample end;
+  bench_perf_read(&perf, &end);
+
+  stats[stage].ns += t1 - t0;
+  for (int i = 0; i < BENCH_COUNTER_COUNT; i++)
+    stats[stage].counter[i] += end.value[i] - begin->value[i];
+}
+
+static void load_input(short *pcm, size_t count, const char *path) {
+  size_t got = 0;
+  if (path) {
+    FILE *f = fopen(path, "rb");
+    if (f) {
+      got = fread(pcm, sizeof(short), count, f);
+      fclose(f);
+    } else {
+      fprintf(stderr, "Cannot open %s, using synthetic noise\n", path);
+    }
+  }
+
+  // Loop the file, or fill with white noise when no file was given.
+  uint32_t seed = 0x12345678u;
+  for (size_t i = got; i < count; i++) {
+    if (got > 0) {
+      pcm[i] = pcm[i % got];
+    } else {
+      seed = seed * 1664525u + 1013904223u;
+      pcm[i] = (short)((int32_t)(seed >> 16) - 32768) / 8;
+    }
+  }
+}
+
+static void print_row(const char *name, const StageStats *s, size_t frames) {
+  double f = (double)frames;
+  printf("%-12s %10.1f", name, s->ns / f);
+
+  if (bench_perf_has(&perf, BENCH_CYCLES))
+    printf(" %12.0f", s->counter[BENCH_CYCLES] / f);
+  else
+    printf(" %12s", "n/a");
+
+  if (bench_perf_has(&perf, BENCH_CYCLES) &&
+      bench_perf_has(&perf, BENCH_INSTRUCTIONS) && s->counter[BENCH_CYCLES])
+    printf(" %6.2f", (double)s->counter[BENCH_INSTRUCTIONS] /
+                         (double)s->counter[BENCH_CYCLES]);
+  else
+    printf(" %6s", "n/a");
+
+  for (int i = BENCH_L1D_MISSES; i < BENCH_COUNTER_COUNT; i++) {
+    if (bench_perf_has(&perf, (BenchCounter)i))
+      printf(" %14.1f", s->counter[i] / f);
+    else
+      printf(" %14s", "n/a");
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "Usage: %s <sample rate> [frames] [resample quality] [input.pcm]\n",
+            argv[0]);
+    return 1;
+  }
+
+  unsigned int sample_rate = atoi(argv[1]);
+  size_t frames = argc > 2 ? strtoul(argv[2], NULL, 10) : 6000;
+  int quality = argc > 3 ? atoi(argv[3]) : 4;
+  const char *input_path = argc > 4 ? argv[4] : NULL;
+
+  unsigned int in_len = calculate_frame_sample(sample_rate);
+  if (in_len == 0 || in_len > FRAME_SIZE * 4 || frames == 0) {
+    fprintf(stderr, "Invalid sample rate or frame count\n");
+    return 1;
+  }
+  bool need_resample = sample_rate != FRAME_RATE;
+
+  short *pcm = malloc(sizeof(short) * in_len * frames);
+  if (!pcm)
+    return 1;
+  load_input(pcm, (size_t)in_len * frames, input_path);
+
+  AudxDenoiseState *denoiser = audx_denoise_create(NULL);
+  AudxResamplerState *upsampler = NULL;
+  AudxResamplerState *downsampler = NULL;
+  if (need_resample) {
+    upsampler = audx_resampler_create(sample_rate, FRAME_RATE, quality);
+    downsampler = audx_resampler_create(FRAME_RATE, sample_rate, quality);
+  }
+  if (!denoiser || (need_resample && (!upsampler || !downsampler))) {
+    fprintf(stderr, "Failed to create pipeline\n");
+    return 1;
+  }
+
+  if (!bench_perf_open(&perf))
+    fprintf(stderr, "Hardware counters unavailable (check "
+                    "/proc/sys/kernel/perf_event_paranoid), timing only\n");
+
+  float in_f[FRAME_SIZE * 4];
+  float up[FRAME_SIZE];
+  float den[FRAME_SIZE];
+  float out_f[FRAME_SIZE * 4];
+  short out[FRAME_SIZE * 4];
+  BenchSample sample;
+  uint64_t t0;
+
+  for (size_t n = 0; n < frames; n++) {
+    const short *in = pcm + n * in_len;
+
+    stage_begin(&sample, &t0);
+    pcm_int16_to_float(in, in_f, in_len);
+    stage_end(STAGE_CONVERT_IN, &sample, t0);
+
+    if (need_resample) {
+      unsigned int frame_size = FRAME_SIZE;
+      unsigned int len = in_len;
+
+      stage_begin(&sample, &t0);
+      audx_resampler_process(upsampler, in_f, &len, up, &frame_size);
+      stage_end(STAGE_UPSAMPLE, &sample, t0);
+
+      stage_begin(&sample, &t0);
+      audx_denoise_process(denoiser, up, den);
+      stage_end(STAGE_DENOISE, &sample, t0);
+
+      stage_begin(&sample, &t0);
+      audx_resampler_process(downsampler, den, &frame_size, out_f, &len);
+      stage_end(STAGE_DOWNSAMPLE, &sample, t0);
+    } else {
+      stage_begin(&sample, &t0);
+      audx_denoise_process(denoiser, in_f, out_f);
+      stage_end(STAGE_DENOISE, &sample, t0);
+    }
+
+    stage_begin(&sample, &t0);
+    pcm_float_to_int16(out_f, out, in_len);
+    stage_end(STAGE_CONVERT_OUT, &sample, t0);
+  }
+
+  printf("rate=%u quality=%d frames=%zu\n", sample_rate, quality, frames);
+  printf("%-12s %10s %12s %6s", "stage", "ns/frame", "cycles/frame", "IPC");
+  for (int i = BENCH_L1D_MISSES; i < BENCH_COUNTER_COUNT; i++)
+    printf(" %14s", bench_counter_names[i]);
+  printf("\n");
+
+  StageStats total = {0};
+  for (int s = 0; s < STAGE_COUNT; s++) {
+    if (!need_resample && (s == STAGE_UPSAMPLE || s == STAGE_DOWNSAMPLE))
+      continue;
+    print_row(stage_names[s], &stats[s], frames);
+    total.ns += stats[s].ns;
+    for (int i = 0; i < BENCH_COUNTER_COUNT; i++)
+      total.counter[i] += stats[s].counter[i];
+  }
+  print_row("total", &total, frames);
+
+  double frame_ns = 10e6;
+  printf("realtime factor: %.1fx\n", frame_ns / ((double)total.ns / frames));
+
+  bench_perf_close(&perf);
+  audx_denoise_destroy(denoiser);
+  audx_resampler_destroy(upsampler);
+  audx_resampler_destroy(downsampler);
+  free(pcm);
+  return 0;
+}
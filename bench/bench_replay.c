@@ -0,0 +1,197 @@
+#include "audx.h"
+#include "audx_capture.h"
+#include "audx_time.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Replay a traffic capture (see audx_capture.h) through fresh AudxStates.
+ *
+ * Every stream in the capture gets its own state at the recorded sample rate.
+ * Frames are fed at their original pacing, or back to back with --max-speed,
+ * and per-frame processing latency is reported per stream and overall.
+ */
+
+typedef struct ReplayStream {
+  uint32_t stream_id;
+  uint32_t sample_rate;
+  AudxState *state;
+  size_t frames;
+  uint64_t total_ns;
+  uint64_t max_ns;
+} ReplayStream;
+
+typedef struct ReplayStats {
+  ReplayStream *streams;
+  size_t count;
+  size_t capacity;
+  float *latency_us;
+  size_t latency_count;
+  size_t latency_capacity;
+} ReplayStats;
+
+static ReplayStream *find_stream(ReplayStats *stats, uint32_t stream_id,
+                                 uint32_t sample_rate) {
+  for (size_t i = 0; i < stats->count; i++)
+    if (stats->streams[i].stream_id == stream_id)
+      return &stats->streams[i];
+
+  if (stats->count == stats->capacity) {
+    size_t capacity = stats->capacity ? stats->capacity * 2 : 16;
+    ReplayStream *grown =
+        realloc(stats->streams, capacity * sizeof(ReplayStream));
+    if (!grown)
+      return NULL;
+    stats->streams = grown;
+    stats->capacity = capacity;
+  }
+
+  ReplayStream *stream = &stats->streams[stats->count];
+  memset(stream, 0, sizeof(*stream));
+  stream->stream_id = stream_id;
+  stream->sample_rate = sample_rate;
+  stream->state = audx_create(NULL, sample_rate, 4);
+  if (!stream->state)
+    return NULL;
+
+  stats->count++;
+  return stream;
+}
+
+static bool add_latency(ReplayStats *stats, float us) {
+  if (stats->latency_count == stats->latency_capacity) {
+    size_t capacity =
+        stats->latency_capacity ? stats->latency_capacity * 2 : 4096;
+    float *grown = realloc(stats->latency_us, capacity * sizeof(float));
+    if (!grown)
+      return false;
+    stats->latency_us = grown;
+    stats->latency_capacity = capacity;
+  }
+  stats->latency_us[stats->latency_count++] = us;
+  return true;
+}
+
+static int compare_float(const void *a, const void *b) {
+  float fa = *(const float *)a, fb = *(const float *)b;
+  return (fa > fb) - (fa < fb);
+}
+
+static void sleep_until(uint64_t deadline_ns) {
+  uint64_t now = audx_now_ns();
+  if (now >= deadline_ns)
+    return;
+
+  uint64_t wait = deadline_ns - now;
+  struct timespec ts = {(time_t)(wait / 1000000000),
+                        (long)(wait % 1000000000)};
+  nanosleep(&ts, NULL);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <capture file> [--max-speed]\n", argv[0]);
+    return 1;
+  }
+  bool max_speed = argc > 2 && strcmp(argv[2], "--max-speed") == 0;
+
+  FILE *f = fopen(argv[1], "rb");
+  if (!f) {
+    fprintf(stderr, "Cannot open %s\n", argv[1]);
+    return 1;
+  }
+
+  AudxCaptureFileHeader header;
+  if (fread(&header, sizeof(header), 1, f) != 1 ||
+      memcmp(header.magic, AUDX_CAPTURE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != AUDX_CAPTURE_VERSION ||
+      header.record_size != sizeof(AudxCaptureRecord)) {
+    fprintf(stderr, "%s is not a supported capture file\n", argv[1]);
+    fclose(f);
+    return 1;
+  }
+
+  ReplayStats stats = {0};
+  uint64_t first_ts = 0;
+  uint64_t start_ns = audx_now_ns();
+  size_t skipped = 0;
+
+  // Largest frame: 10ms at 192kHz, as float.
+  static float in_f[1920];
+  static float out_f[1920];
+  short *in_s = (short *)in_f;
+  short *out_s = (short *)out_f;
+
+  AudxCaptureRecord record;
+  while (fread(&record, sizeof(record), 1, f) == 1) {
+    size_t sample_size = record.format == AUDX_CAPTURE_F32 ? 4 : 2;
+    if (record.samples > 1920 || record.format > AUDX_CAPTURE_F32 ||
+        fread(in_f, sample_size, record.samples, f) != record.samples) {
+      fprintf(stderr, "Truncated or corrupt record, stopping\n");
+      break;
+    }
+
+    ReplayStream *stream =
+        find_stream(&stats, record.stream_id, record.sample_rate);
+    if (!stream) {
+      fprintf(stderr, "Cannot create state for stream %u (%u Hz)\n",
+              record.stream_id, record.sample_rate);
+      return 1;
+    }
+    if (record.samples != calculate_frame_sample(stream->sample_rate)) {
+      skipped++;
+      continue;
+    }
+
+    if (first_ts == 0)
+      first_ts = record.timestamp_ns;
+    if (!max_speed)
+      sleep_until(start_ns + (record.timestamp_ns - first_ts));
+
+    uint64_t t0 = audx_now_ns();
+    if (record.format == AUDX_CAPTURE_F32)
+      audx_process(stream->state, in_f, out_f);
+    else
+      audx_process_int(stream->state, in_s, out_s);
+    uint64_t elapsed = audx_now_ns() - t0;
+
+    stream->frames++;
+    stream->total_ns += elapsed;
+    if (elapsed > stream->max_ns)
+      stream->max_ns = elapsed;
+    if (!add_latency(&stats, elapsed / 1e3f))
+      return 1;
+  }
+  fclose(f);
+
+  uint64_t busy_ns = 0;
+  printf("%10s %8s %10s %10s %10s\n", "stream", "rate", "frames", "mean_us",
+         "max_us");
+  for (size_t i = 0; i < stats.count; i++) {
+    ReplayStream *s = &stats.streams[i];
+    printf("%10u %8u %10zu %10.1f %10.1f\n", s->stream_id, s->sample_rate,
+           s->frames, s->frames ? s->total_ns / 1e3 / s->frames : 0.0,
+           s->max_ns / 1e3);
+    busy_ns += s->total_ns;
+    audx_destroy(s->state);
+  }
+
+  if (stats.latency_count) {
+    qsort(stats.latency_us, stats.latency_count, sizeof(float),
+          compare_float);
+    printf("\nframes %zu (skipped %zu), p50 %.1f us, p99 %.1f us, max %.1f "
+           "us, realtime factor %.1fx\n",
+           stats.latency_count, skipped,
+           stats.latency_us[stats.latency_count / 2],
+           stats.latency_us[(size_t)(stats.latency_count * 0.99)],
+           stats.latency_us[stats.latency_count - 1],
+           stats.latency_count * 10e6 / (double)busy_ns);
+  }
+
+  free(stats.streams);
+  free(stats.latency_us);
+  return 0;
+}
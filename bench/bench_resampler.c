@@ -0,0 +1,235 @@
+#include "audx_resampler.h"
+#include "audx_time.h"
+#include "speex/speex_resampler.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Frequency response check for the half-band cascades.
+ *
+ * Converts 88.2, 96 and 192 kHz to and from 48 kHz through AudxResampler,
+ * which uses the half-band stages, and through a single SpeexDSP resampler
+ * of the same quality. Each path gets one sine tone at a time:
+ *
+ * - Passband tones, up to 0.4 of 48 kHz, give the gain of the path; the
+ *   ripple is the spread of those gains. Whatever a tone leaves in the output
+ *   besides itself, images when interpolating and aliases when decimating,
+ *   counts against the rejection.
+ * - When decimating, stopband tones that 48 kHz sampling would fold onto the
+ *   passband must not come through at all; their output level counts
+ *   against the rejection too. Tones that fold between the passband and
+ *   24 kHz are left out, as the stages let those through by design.
+ *
+ * Tones sit on multiples of 10 Hz and are measured over 100 ms, a whole
+ * number of periods at every rate, so a least-squares fit separates the tone
+ * from the rest exactly. Prints CSV:
+ *
+ *   rate,direction,speex_ripple_db,audx_ripple_db,speex_rejection_db,
+ *   audx_rejection_db,speex_ns,audx_ns,result
+ *
+ * with times per input sample, and exits non-zero if the cascade's ripple is
+ * more than RIPPLE_MARGIN_DB above SpeexDSP's, or its rejection falls short
+ * of SpeexDSP's or 80 dB, whichever is lower, by more than
+ * REJECTION_MARGIN_DB. The optional argument is the SpeexDSP quality.
+ */
+
+#define LOW_RATE 48000u
+#define PASSBAND_HZ (0.4 * LOW_RATE)
+#define PASSBAND_TONES 40
+#define STOPBAND_TONES 60
+#define AMPLITUDE 0.5
+#define MIN_REJECTION_DB 80.0
+#define RIPPLE_MARGIN_DB 0.05
+#define REJECTION_MARGIN_DB 3.0
+#define BLOCK 480u
+
+typedef struct Response {
+  double gain_min_db;
+  double gain_max_db;
+  double rejection_db; // Worst case over all tones
+  double ns;
+  size_t samples;
+} Response;
+
+/**
+ * Convert in[0..n) through a fresh converter. Input goes in blocks of BLOCK,
+ * as audx feeds its resamplers, followed by silence until max_out samples
+ * have come out or the converter stops producing.
+ */
+static size_t convert(bool cascade, unsigned int in_rate,
+                      unsigned int out_rate, int quality, const float *in,
+                      size_t n, float *out, size_t max_out, Response *r) {
+  AudxResamplerState *audx = NULL;
+  SpeexResamplerState *spx = NULL;
+  int err = 0;
+  if (cascade)
+    audx = audx_resampler_create(in_rate, out_rate, quality);
+  else
+    spx = speex_resampler_init(1, in_rate, out_rate, quality, &err);
+  if (!audx && !spx)
+    return 0;
+
+  static const float zeros[BLOCK];
+  size_t consumed = 0, produced = 0;
+  uint64_t start = audx_now_ns();
+  while (produced < max_out) {
+    const float *src = consumed < n ? in + consumed : zeros;
+    unsigned int in_len = BLOCK;
+    if (consumed < n && n - consumed < in_len)
+      in_len = (unsigned int)(n - consumed);
+    unsigned int out_len = (unsigned int)(max_out - produced);
+    int ret = cascade ? audx_resampler_process(audx, src, &in_len,
+                                               out + produced, &out_len)
+                      : speex_resampler_process_float(spx, 0, src, &in_len,
+                                                      out + produced,
+                                                      &out_len);
+    if (ret != 0 || (in_len == 0 && out_len == 0))
+      break;
+    consumed += in_len;
+    produced += out_len;
+  }
+  r->ns += (double)(audx_now_ns() - start);
+  r->samples += consumed;
+
+  audx_resampler_destroy(audx);
+  if (spx)
+    speex_resampler_destroy(spx);
+  return produced;
+}
+
+/**
+ * Run one tone through a path. Returns the gain of the tone in dB and the
+ * level of everything else relative to the input tone, or -1 on error.
+ */
+static int measure_tone(bool cascade, unsigned int in_rate,
+                        unsigned int out_rate, int quality, double freq,
+                        double *gain_db, double *rest_db, Response *r) {
+  // 50 ms to settle, then the 100 ms window
+  const size_t skip = out_rate / 20, window = out_rate / 10;
+  const size_t n = (size_t)in_rate * 3 / 20;
+  float *in = malloc(sizeof(float) * n);
+  float *out = malloc(sizeof(float) * (skip + window));
+  if (!in || !out) {
+    free(in);
+    free(out);
+    return -1;
+  }
+
+  for (size_t i = 0; i < n; i++)
+    in[i] = (float)(AMPLITUDE * sin(2.0 * M_PI * freq * (double)i / in_rate));
+  size_t got = convert(cascade, in_rate, out_rate, quality, in, n, out,
+                       skip + window, r);
+  free(in);
+  if (got < skip + window) {
+    free(out);
+    return -1;
+  }
+
+  // The window holds freq / 10 whole periods, so sin and cos are orthogonal
+  // over it and the projections are the least-squares fit.
+  const float *y = out + skip;
+  const double w = 2.0 * M_PI * freq / out_rate;
+  double a = 0.0, b = 0.0;
+  for (size_t i = 0; i < window; i++) {
+    a += y[i] * sin(w * (double)(skip + i));
+    b += y[i] * cos(w * (double)(skip + i));
+  }
+  a *= 2.0 / (double)window;
+  b *= 2.0 / (double)window;
+
+  double rest = 0.0;
+  for (size_t i = 0; i < window; i++) {
+    double e = y[i] - a * sin(w * (double)(skip + i)) -
+               b * cos(w * (double)(skip + i));
+    rest += e * e;
+  }
+  free(out);
+
+  const double tone_rms = AMPLITUDE / sqrt(2.0);
+  *gain_db = 20.0 * log10(sqrt(a * a + b * b) / AMPLITUDE);
+  *rest_db = 20.0 * log10(sqrt(rest / (double)window) / tone_rms + 1e-12);
+  return 0;
+}
+
+// Tones are rounded to 10 Hz so that they fit the measurement window.
+static double tone_at(double lo, double hi, int i, int count) {
+  return round((lo + (hi - lo) * i / (count - 1)) / 10.0) * 10.0;
+}
+
+static int measure_path(bool cascade, unsigned int in_rate,
+                        unsigned int out_rate, int quality, Response *r) {
+  *r = (Response){.gain_min_db = INFINITY, .gain_max_db = -INFINITY,
+                  .rejection_db = INFINITY};
+  double gain, rest;
+
+  for (int i = 0; i < PASSBAND_TONES; i++) {
+    double freq = tone_at(100.0, PASSBAND_HZ, i, PASSBAND_TONES);
+    if (measure_tone(cascade, in_rate, out_rate, quality, freq, &gain, &rest,
+                     r) != 0)
+      return -1;
+    r->gain_min_db = fmin(r->gain_min_db, gain);
+    r->gain_max_db = fmax(r->gain_max_db, gain);
+    r->rejection_db = fmin(r->rejection_db, -rest);
+  }
+
+  if (in_rate > out_rate) {
+    double hi = 0.49 * in_rate;
+    for (int i = 0; i < STOPBAND_TONES; i++) {
+      double freq = tone_at(LOW_RATE - PASSBAND_HZ, hi, i, STOPBAND_TONES);
+      double folded = fmod(freq, LOW_RATE);
+      if (fmin(folded, LOW_RATE - folded) > PASSBAND_HZ)
+        continue;
+      if (measure_tone(cascade, in_rate, out_rate, quality, freq, &gain,
+                       &rest, r) != 0)
+        return -1;
+      // Everything that comes out is leakage.
+      double level = 10.0 * log10(pow(10.0, gain / 10.0) +
+                                  pow(10.0, rest / 10.0));
+      r->rejection_db = fmin(r->rejection_db, -level);
+    }
+  }
+  return 0;
+}
+
+static bool check(unsigned int rate, bool decimate, int quality) {
+  unsigned int in_rate = decimate ? rate : LOW_RATE;
+  unsigned int out_rate = decimate ? LOW_RATE : rate;
+  Response spx, audx;
+  if (measure_path(false, in_rate, out_rate, quality, &spx) != 0 ||
+      measure_path(true, in_rate, out_rate, quality, &audx) != 0) {
+    printf("%u,%s,,,,,,,ERROR\n", rate, decimate ? "down" : "up");
+    return false;
+  }
+
+  double spx_ripple = spx.gain_max_db - spx.gain_min_db;
+  double audx_ripple = audx.gain_max_db - audx.gain_min_db;
+  double floor_db = fmin(spx.rejection_db, MIN_REJECTION_DB);
+  bool pass = audx_ripple <= spx_ripple + RIPPLE_MARGIN_DB &&
+              audx.rejection_db >= floor_db - REJECTION_MARGIN_DB;
+  printf("%u,%s,%.4f,%.4f,%.1f,%.1f,%.1f,%.1f,%s\n", rate,
+         decimate ? "down" : "up", spx_ripple, audx_ripple, spx.rejection_db,
+         audx.rejection_db, spx.ns / (double)spx.samples,
+         audx.ns / (double)audx.samples, pass ? "ok" : "FAIL");
+  return pass;
+}
+
+int main(int argc, char **argv) {
+  int quality = argc > 1 ? atoi(argv[1]) : 4;
+  if (quality < 0 || quality > 10) {
+    fprintf(stderr, "Usage: %s [resample quality 0-10]\n", argv[0]);
+    return 1;
+  }
+
+  static const unsigned int rates[] = {88200, 96000, 192000};
+  printf("rate,direction,speex_ripple_db,audx_ripple_db,speex_rejection_db,"
+         "audx_rejection_db,speex_ns,audx_ns,result\n");
+
+  bool pass = true;
+  for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    pass &= check(rates[i], true, quality);
+    pass &= check(rates[i], false, quality);
+  }
+  return pass ? 0 : 1;
+}
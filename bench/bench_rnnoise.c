@@ -0,0 +1,490 @@
+#include "audx_bands.h"
+#include "audx_fft.h"
+#include "audx_time.h"
+#include "kiss_fft.h"
+#include "pitch.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Equivalence check and benchmark for the kernels audx builds into RNNoise.
+ *
+ * Each kernel is run on random input next to the upstream code it replaces:
+ * kiss_fft and denoise.c's band functions stay in the rnnoise target under
+ * _generic names, and pitch.c is built into this program by
+ * bench_rnnoise_pitch.c. The largest difference is reported against a
+ * tolerance relative to the output's peak, along with the time per call of
+ * both versions. Prints CSV:
+ *
+ *   kernel,max_error,tolerance,generic_ns,audx_ns,result
+ *
+ * and exits non-zero if any kernel is out of tolerance. An optional second
+ * argument limits the run to one group of kernels (fft, pitch or bands), as
+ * the ctest entries do.
+ */
+
+static size_t iterations = 1000;
+static uint32_t seed = 0x12345678u;
+
+static float next_random(void) {
+  seed = seed * 1664525u + 1013904223u;
+  return ((int32_t)(seed >> 8) - (1 << 23)) / (float)(1 << 23);
+}
+
+static bool report(const char *kernel, float max_error, float tolerance,
+                   double generic_ns, double audx_ns) {
+  bool pass = max_error <= tolerance;
+  printf("%s,%.3g,%.3g,%.1f,%.1f,%s\n", kernel, max_error, tolerance,
+         generic_ns, audx_ns, pass ? "ok" : "FAIL");
+  return pass;
+}
+
+#if defined(AUDX_RNNOISE_PITCH) || defined(AUDX_RNNOISE_BANDS)
+static float peak(const float *x, int n) {
+  float peak = 0.0f;
+  for (int i = 0; i < n; i++)
+    peak = fmaxf(peak, fabsf(x[i]));
+  return peak;
+}
+
+static float max_diff(const float *a, const float *b, int n) {
+  float diff = 0.0f;
+  for (int i = 0; i < n; i++)
+    diff = fmaxf(diff, fabsf(a[i] - b[i]));
+  return diff;
+}
+
+#endif
+
+/* --- FFT --- */
+
+#ifdef AUDX_RNNOISE_FFT
+// kiss_fft.c is built with its rnn_fft_c renamed to this
+void rnn_fft_c_generic(const kiss_fft_state *st, const kiss_fft_cpx *fin,
+                       kiss_fft_cpx *fout);
+
+#define FFT_TOLERANCE 1e-5f
+
+static float peak_cpx(const kiss_fft_cpx *x, int n) {
+  float peak = 0.0f;
+  for (int i = 0; i < n; i++)
+    peak = fmaxf(peak, fmaxf(fabsf(x[i].r), fabsf(x[i].i)));
+  return peak;
+}
+
+static float max_diff_cpx(const kiss_fft_cpx *a, const kiss_fft_cpx *b,
+                          int n) {
+  float diff = 0.0f;
+  for (int i = 0; i < n; i++)
+    diff = fmaxf(diff, fmaxf(fabsf(a[i].r - b[i].r), fabsf(a[i].i - b[i].i)));
+  return diff;
+}
+
+/**
+ * Forward: a real window through audx_fft_forward() and through the
+ * interposed rnn_fft_c(), against kiss_fft.
+ *
+ * Inverse: the Hermitian spectrum of that window through audx_fft_inverse()
+ * and rnn_fft_c(), against kiss_fft's forward transform of the conjugated
+ * spectrum, which is the inverse transform of the spectrum itself.
+ */
+static bool check_fft(void) {
+  kiss_fft_state *st = rnn_fft_alloc(AUDX_FFT_SIZE, NULL, NULL, 0);
+  if (!st) {
+    fprintf(stderr, "Failed to allocate a %d-point kiss_fft\n",
+            AUDX_FFT_SIZE);
+    return false;
+  }
+
+  static kiss_fft_cpx x[AUDX_FFT_SIZE], ref[AUDX_FFT_SIZE];
+  static kiss_fft_cpx got[AUDX_FFT_SIZE], spectrum[AUDX_FFT_SIZE];
+  static float in[AUDX_FFT_SIZE], out[AUDX_FFT_SIZE];
+  static float re[AUDX_FFT_BINS], im[AUDX_FFT_BINS];
+
+  for (int n = 0; n < AUDX_FFT_SIZE; n++) {
+    in[n] = 32768.0f * next_random();
+    x[n].r = in[n];
+    x[n].i = 0.0f;
+  }
+
+  bool pass = true;
+  uint64_t t0, t_generic, t_audx;
+
+  // Forward
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    rnn_fft_c_generic(st, x, ref);
+  t_generic = audx_now_ns() - t0;
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    audx_fft_forward(in, re, im);
+  t_audx = audx_now_ns() - t0;
+
+  for (int k = 0; k < AUDX_FFT_SIZE; k++) {
+    int bin = k < AUDX_FFT_BINS ? k : AUDX_FFT_SIZE - k;
+    float sign = k < AUDX_FFT_BINS ? 1.0f : -1.0f;
+    got[k].r = st->scale * re[bin];
+    got[k].i = sign * st->scale * im[bin];
+  }
+  float tolerance = FFT_TOLERANCE * peak_cpx(ref, AUDX_FFT_SIZE);
+  pass &= report("audx_fft_forward", max_diff_cpx(got, ref, AUDX_FFT_SIZE),
+                 tolerance, (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    rnn_fft_c(st, x, got);
+  t_audx = audx_now_ns() - t0;
+  pass &= report("rnn_fft_c forward", max_diff_cpx(got, ref, AUDX_FFT_SIZE),
+                 tolerance, (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  // Inverse of the first half of that spectrum, mirrored into an exactly
+  // Hermitian one as RNNoise's synthesis does
+  for (int k = 0; k < AUDX_FFT_BINS; k++) {
+    re[k] = ref[k].r;
+    im[k] = k == 0 || k == AUDX_FFT_BINS - 1 ? 0.0f : ref[k].i;
+  }
+  for (int k = 0; k < AUDX_FFT_SIZE; k++) {
+    int bin = k < AUDX_FFT_BINS ? k : AUDX_FFT_SIZE - k;
+    float sign = k < AUDX_FFT_BINS ? 1.0f : -1.0f;
+    spectrum[k].r = re[bin];
+    spectrum[k].i = -sign * im[bin];
+  }
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    rnn_fft_c_generic(st, spectrum, ref);
+  t_generic = audx_now_ns() - t0;
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    audx_fft_inverse(re, im, out);
+  t_audx = audx_now_ns() - t0;
+
+  for (int n = 0; n < AUDX_FFT_SIZE; n++) {
+    got[n].r = st->scale * out[n];
+    got[n].i = 0.0f;
+  }
+  tolerance = FFT_TOLERANCE * peak_cpx(ref, AUDX_FFT_SIZE);
+  pass &= report("audx_fft_inverse", max_diff_cpx(got, ref, AUDX_FFT_SIZE),
+                 tolerance, (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    rnn_fft_c(st, spectrum, got);
+  t_audx = audx_now_ns() - t0;
+  pass &= report("rnn_fft_c inverse", max_diff_cpx(got, ref, AUDX_FFT_SIZE),
+                 tolerance, (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  rnn_fft_free(st, 0);
+  return pass;
+}
+#endif // AUDX_RNNOISE_FFT
+
+/* --- Pitch analysis --- */
+
+#ifdef AUDX_RNNOISE_PITCH
+// Upstream pitch.c, built into this program by bench_rnnoise_pitch.c
+void ref_pitch_downsample(celt_sig *x[], opus_val16 *x_lp, int len, int C);
+void ref_pitch_search(const opus_val16 *x_lp, opus_val16 *y, int len,
+                      int max_pitch, int *pitch);
+opus_val16 ref_remove_doubling(opus_val16 *x, int maxperiod, int minperiod,
+                               int N, int *T0, int prev_period,
+                               opus_val16 prev_gain);
+void ref_celt_pitch_xcorr(const opus_val16 *_x, const opus_val16 *_y,
+                          opus_val32 *xcorr, int len, int max_pitch);
+
+// As RNNoise's denoise.c calls the pitch analysis
+#define PITCH_MIN_PERIOD 60
+#define PITCH_MAX_PERIOD 768
+#define PITCH_FRAME_SIZE 960
+#define PITCH_BUF_SIZE (PITCH_MAX_PERIOD + PITCH_FRAME_SIZE)
+
+// The downsampling filter is fitted to the signal, so rounding differences
+// in its autocorrelation reach the output amplified.
+#define PITCH_SIGNAL_TOLERANCE 1e-3f
+#define PITCH_GAIN_TOLERANCE 1e-4f
+
+/**
+ * One RNNoise pitch analysis per frame on a two-harmonic tone with noise,
+ * sweeping the fundamental across the search range. Each stage is run by
+ * both implementations on the same input, taken from the upstream chain.
+ * Periods must match exactly, signals to PITCH_SIGNAL_TOLERANCE of their
+ * peak and gains to PITCH_GAIN_TOLERANCE.
+ */
+static bool check_pitch(void) {
+  static float pre[PITCH_BUF_SIZE];
+  static float ref_buf[PITCH_BUF_SIZE >> 1], got_buf[PITCH_BUF_SIZE >> 1];
+  static float ref_xcorr[PITCH_MAX_PERIOD], got_xcorr[PITCH_MAX_PERIOD];
+  const int xcorr_len = PITCH_FRAME_SIZE >> 2;
+  const int xcorr_lags = (PITCH_MAX_PERIOD - 3 * PITCH_MIN_PERIOD) >> 2;
+
+  float lp_error = 0.0f, lp_peak = 0.0f;
+  float xcorr_error = 0.0f, xcorr_peak = 0.0f;
+  float gain_error = 0.0f;
+  int search_mismatch = 0, doubling_mismatch = 0;
+  uint64_t ref_ns[4] = {0}, got_ns[4] = {0}, t0;
+
+  int last_period = 0;
+  float last_gain = 0.0f;
+  for (size_t frame = 0; frame < iterations; frame++) {
+    float f0 = 70.0f + (float)(frame * 7 % 640);
+    for (int i = 0; i < PITCH_BUF_SIZE; i++) {
+      float t = (float)i / 48000.0f;
+      pre[i] = 8000.0f * sinf(2.0f * (float)M_PI * f0 * t) +
+               4000.0f * sinf(4.0f * (float)M_PI * f0 * t + 1.0f) +
+               800.0f * next_random();
+    }
+    celt_sig *channels[1] = {pre};
+
+    t0 = audx_now_ns();
+    ref_pitch_downsample(channels, ref_buf, PITCH_BUF_SIZE, 1);
+    ref_ns[0] += audx_now_ns() - t0;
+    t0 = audx_now_ns();
+    pitch_downsample(channels, got_buf, PITCH_BUF_SIZE, 1);
+    got_ns[0] += audx_now_ns() - t0;
+    lp_error =
+        fmaxf(lp_error, max_diff(ref_buf, got_buf, PITCH_BUF_SIZE >> 1));
+    lp_peak = fmaxf(lp_peak, peak(ref_buf, PITCH_BUF_SIZE >> 1));
+
+    t0 = audx_now_ns();
+    ref_celt_pitch_xcorr(ref_buf, ref_buf, ref_xcorr, xcorr_len, xcorr_lags);
+    ref_ns[1] += audx_now_ns() - t0;
+    t0 = audx_now_ns();
+    celt_pitch_xcorr(ref_buf, ref_buf, got_xcorr, xcorr_len, xcorr_lags);
+    got_ns[1] += audx_now_ns() - t0;
+    xcorr_error =
+        fmaxf(xcorr_error, max_diff(ref_xcorr, got_xcorr, xcorr_lags));
+    xcorr_peak = fmaxf(xcorr_peak, peak(ref_xcorr, xcorr_lags));
+
+    int ref_index, got_index;
+    t0 = audx_now_ns();
+    ref_pitch_search(ref_buf + (PITCH_MAX_PERIOD >> 1), ref_buf,
+                     PITCH_FRAME_SIZE, PITCH_MAX_PERIOD - 3 * PITCH_MIN_PERIOD,
+                     &ref_index);
+    ref_ns[2] += audx_now_ns() - t0;
+    t0 = audx_now_ns();
+    pitch_search(ref_buf + (PITCH_MAX_PERIOD >> 1), ref_buf, PITCH_FRAME_SIZE,
+                 PITCH_MAX_PERIOD - 3 * PITCH_MIN_PERIOD, &got_index);
+    got_ns[2] += audx_now_ns() - t0;
+    search_mismatch += ref_index != got_index;
+
+    int ref_period = PITCH_MAX_PERIOD - ref_index;
+    int got_period = ref_period;
+    t0 = audx_now_ns();
+    float ref_gain = ref_remove_doubling(ref_buf, PITCH_MAX_PERIOD,
+                                         PITCH_MIN_PERIOD, PITCH_FRAME_SIZE,
+                                         &ref_period, last_period, last_gain);
+    ref_ns[3] += audx_now_ns() - t0;
+    t0 = audx_now_ns();
+    float got_gain = remove_doubling(ref_buf, PITCH_MAX_PERIOD,
+                                     PITCH_MIN_PERIOD, PITCH_FRAME_SIZE,
+                                     &got_period, last_period, last_gain);
+    got_ns[3] += audx_now_ns() - t0;
+    doubling_mismatch += ref_period != got_period;
+    gain_error = fmaxf(gain_error, fabsf(ref_gain - got_gain));
+
+    last_period = ref_period;
+    last_gain = ref_gain;
+  }
+
+  bool pass = true;
+  double n = (double)iterations;
+  pass &= report("pitch_downsample", lp_error,
+                 PITCH_SIGNAL_TOLERANCE * lp_peak, ref_ns[0] / n,
+                 got_ns[0] / n);
+  pass &= report("celt_pitch_xcorr", xcorr_error,
+                 PITCH_SIGNAL_TOLERANCE * xcorr_peak, ref_ns[1] / n,
+                 got_ns[1] / n);
+  pass &= report("pitch_search period", (float)search_mismatch, 0.0f,
+                 ref_ns[2] / n, got_ns[2] / n);
+  pass &= report("remove_doubling period", (float)doubling_mismatch, 0.0f,
+                 ref_ns[3] / n, got_ns[3] / n);
+  pass &= report("remove_doubling gain", gain_error, PITCH_GAIN_TOLERANCE,
+                 ref_ns[3] / n, got_ns[3] / n);
+  return pass;
+}
+#endif // AUDX_RNNOISE_PITCH
+
+/* --- Band kernels --- */
+
+#ifdef AUDX_RNNOISE_BANDS
+#define BANDS_TOLERANCE 1e-5f
+#define PITCH_FILTER_TOLERANCE 1e-4f
+
+#define MAX_BINS 1024
+#define MAX_BANDS 64
+#define MAX_WINDOW 2048
+
+static void random_spectrum(kiss_fft_cpx *X, int bins) {
+  for (int k = 0; k < bins; k++) {
+    X[k].r = 1000.0f * next_random();
+    X[k].i = 1000.0f * next_random();
+  }
+}
+
+/**
+ * Each kernel against the original on the same random input. In-place
+ * kernels restore their input before every timed call, on both sides.
+ */
+static bool check_bands(void) {
+  const AudxBandKernels *k = audx_band_kernels();
+  const int bins = k->bins, bands = k->bands, window = k->window;
+  if (bins > MAX_BINS || bands > MAX_BANDS || window > MAX_WINDOW) {
+    fprintf(stderr, "Unexpected RNNoise sizes: %d bins, %d bands\n", bins,
+            bands);
+    return false;
+  }
+
+  static float x[MAX_WINDOW], ref_x[MAX_WINDOW], got_x[MAX_WINDOW];
+  static kiss_fft_cpx X[MAX_BINS], P[MAX_BINS];
+  static kiss_fft_cpx ref_X[MAX_BINS], got_X[MAX_BINS];
+  static float ref_g[MAX_BINS], got_g[MAX_BINS];
+  float ref_E[MAX_BANDS], got_E[MAX_BANDS];
+  float Ex[MAX_BANDS], Ep[MAX_BANDS], Exp[MAX_BANDS], g[MAX_BANDS];
+  uint64_t t0, t_generic, t_audx;
+  bool pass = true;
+
+  random_spectrum(X, bins);
+  random_spectrum(P, bins);
+  for (int i = 0; i < window; i++)
+    x[i] = 32768.0f * next_random();
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++) {
+    memcpy(ref_x, x, sizeof(float) * window);
+    k->apply_window_generic(ref_x);
+  }
+  t_generic = audx_now_ns() - t0;
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++) {
+    memcpy(got_x, x, sizeof(float) * window);
+    k->apply_window(got_x);
+  }
+  t_audx = audx_now_ns() - t0;
+  pass &= report("apply_window", max_diff(ref_x, got_x, window),
+                 BANDS_TOLERANCE * peak(ref_x, window),
+                 (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    k->band_energy_generic(ref_E, X);
+  t_generic = audx_now_ns() - t0;
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    k->band_energy(got_E, X);
+  t_audx = audx_now_ns() - t0;
+  pass &= report("compute_band_energy", max_diff(ref_E, got_E, bands),
+                 BANDS_TOLERANCE * peak(ref_E, bands),
+                 (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    k->band_corr_generic(ref_E, X, P);
+  t_generic = audx_now_ns() - t0;
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    k->band_corr(got_E, X, P);
+  t_audx = audx_now_ns() - t0;
+  pass &= report("compute_band_corr", max_diff(ref_E, got_E, bands),
+                 BANDS_TOLERANCE * peak(ref_E, bands),
+                 (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  for (int b = 0; b < bands; b++)
+    g[b] = 0.5f + 0.5f * next_random();
+  // Zeroed first, as denoise.c's callers do
+  memset(ref_g, 0, sizeof(float) * bins);
+  memset(got_g, 0, sizeof(float) * bins);
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    k->interp_band_gain_generic(ref_g, g);
+  t_generic = audx_now_ns() - t0;
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++)
+    k->interp_band_gain(got_g, g);
+  t_audx = audx_now_ns() - t0;
+  pass &= report("interp_band_gain", max_diff(ref_g, got_g, bins),
+                 BANDS_TOLERANCE * peak(ref_g, bins),
+                 (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  // The original filter calls the energy and interpolation kernels above,
+  // so this checks the filter's own loops
+  k->band_energy_generic(Ex, X);
+  k->band_energy_generic(Ep, P);
+  for (int b = 0; b < bands; b++) {
+    Exp[b] = 0.5f + 0.5f * next_random();
+    g[b] = 0.5f + 0.5f * next_random();
+  }
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++) {
+    memcpy(ref_X, X, sizeof(kiss_fft_cpx) * bins);
+    k->pitch_filter_generic(ref_X, P, Ex, Ep, Exp, g);
+  }
+  t_generic = audx_now_ns() - t0;
+  t0 = audx_now_ns();
+  for (size_t i = 0; i < iterations; i++) {
+    memcpy(got_X, X, sizeof(kiss_fft_cpx) * bins);
+    k->pitch_filter(got_X, P, Ex, Ep, Exp, g);
+  }
+  t_audx = audx_now_ns() - t0;
+  pass &= report("pitch_filter",
+                 max_diff((float *)ref_X, (float *)got_X, 2 * bins),
+                 PITCH_FILTER_TOLERANCE * peak((float *)ref_X, 2 * bins),
+                 (double)t_generic / iterations,
+                 (double)t_audx / iterations);
+
+  return pass;
+}
+#endif // AUDX_RNNOISE_BANDS
+
+int main(int argc, char **argv) {
+  if (argc > 1)
+    iterations = strtoul(argv[1], NULL, 10);
+  const char *only = argc > 2 ? argv[2] : NULL;
+  if (iterations == 0) {
+    fprintf(stderr, "Usage: %s [iterations] [fft|pitch|bands]\n", argv[0]);
+    return 1;
+  }
+
+  printf("kernel,max_error,tolerance,generic_ns,audx_ns,result\n");
+
+  bool pass = true, ran = false;
+#ifdef AUDX_RNNOISE_FFT
+  if (!only || strcmp(only, "fft") == 0) {
+    pass &= check_fft();
+    ran = true;
+  }
+#endif
+#ifdef AUDX_RNNOISE_PITCH
+  if (!only || strcmp(only, "pitch") == 0) {
+    pass &= check_pitch();
+    ran = true;
+  }
+#endif
+#ifdef AUDX_RNNOISE_BANDS
+  if (!only || strcmp(only, "bands") == 0) {
+    pass &= check_bands();
+    ran = true;
+  }
+#endif
+
+  // Asking for a group that is not built in is an error
+  if (only && !ran) {
+    fprintf(stderr, "No %s kernels in this build\n", only);
+    return 1;
+  }
+
+  return pass ? 0 : 1;
+}
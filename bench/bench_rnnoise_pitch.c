@@ -0,0 +1,12 @@
+/*
+ * RNNoise's own pitch.c under ref_ names, for audx_bench_rnnoise. The rnnoise
+ * target builds src/rnnoise/audx_pitch.c in its place, so this is the only
+ * copy of the upstream code in the program.
+ */
+
+#define pitch_downsample ref_pitch_downsample
+#define pitch_search ref_pitch_search
+#define remove_doubling ref_remove_doubling
+#define celt_pitch_xcorr ref_celt_pitch_xcorr
+
+#include "pitch.c"
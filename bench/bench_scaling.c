@@ -0,0 +1,427 @@
+#define _GNU_SOURCE
+#include "audx.h"
+#include "audx_batch.h"
+#include "audx_pool.h"
+#define AUDX_RT_INTERNAL
+#include "audx_rt.h"
+#include "audx_time.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Multi-stream scaling benchmark.
+ *
+ * Sweeps worker thread count against streams per thread and CPU pinning
+ * policy, for each engine:
+ *
+ *   loop  every thread owns its streams (created on that thread, so pages are
+ *         first touched locally) and processes them round-robin, one 10ms
+ *         frame each per tick, as fast as possible
+ *   pool  the main thread submits one frame of every stream per tick to an
+ *         AudxPool with that many workers and waits for all of them; latency
+ *         runs from submit to the done callback, so it includes queueing
+ *   batch every thread runs audx_denoise_buffer() once per stream over the
+ *         whole input, on its cached state (which resamples at quality 5);
+ *         latency is the call time divided by the frame count
+ *
+ * Results are printed as CSV:
+ *
+ *   engine,threads,streams_per_thread,pinning,frames,wall_s,
+ *   aggregate_rtf,p50_us,p99_us,efficiency
+ *
+ * aggregate_rtf is seconds of audio processed per wall-clock second across
+ * all streams; efficiency compares it to threads x the single-thread run with
+ * the same streams per thread and pinning.
+ */
+
+typedef enum Engine {
+  ENGINE_LOOP = 0,
+  ENGINE_POOL,
+  ENGINE_BATCH,
+  ENGINE_COUNT
+} Engine;
+
+static const char *engine_names[ENGINE_COUNT] = {"loop", "pool", "batch"};
+
+typedef enum Pinning { PIN_NONE = 0, PIN_COMPACT, PIN_COUNT } Pinning;
+
+static const char *pinning_names[PIN_COUNT] = {"none", "compact"};
+
+typedef struct BenchConfig {
+  Engine engine;
+  unsigned int sample_rate;
+  int quality;
+  size_t frames;
+  int threads;
+  int streams_per_thread;
+  Pinning pinning;
+} BenchConfig;
+
+typedef struct Worker {
+  pthread_t thread;
+  int index;
+  const BenchConfig *config;
+  pthread_barrier_t *barrier;
+  const short *input;
+  float *latency_us; // frames * streams_per_thread samples
+  bool failed;
+} Worker;
+
+static void pin_thread(pthread_t thread, int cpu) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+  (void)thread;
+  (void)cpu;
+#endif
+}
+
+static void *worker_main(void *arg) {
+  Worker *w = arg;
+  const BenchConfig *cfg = w->config;
+  unsigned int in_len = calculate_frame_sample(cfg->sample_rate);
+
+  if (cfg->pinning == PIN_COMPACT)
+    pin_thread(pthread_self(), w->index % (int)sysconf(_SC_NPROCESSORS_ONLN));
+
+  AudxState **states = calloc(cfg->streams_per_thread, sizeof(AudxState *));
+  short *out = malloc(sizeof(short) * in_len);
+  if (!states || !out)
+    w->failed = true;
+
+  for (int s = 0; !w->failed && s < cfg->streams_per_thread; s++) {
+    states[s] = audx_create(NULL, cfg->sample_rate, cfg->quality);
+    if (!states[s])
+      w->failed = true;
+  }
+
+  pthread_barrier_wait(w->barrier);
+
+  size_t sample = 0;
+  for (size_t f = 0; !w->failed && f < cfg->frames; f++) {
+    const short *in = w->input + f * in_len;
+    for (int s = 0; s < cfg->streams_per_thread; s++) {
+      uint64_t t0 = audx_now_ns();
+      audx_process_int(states[s], (short *)in, out);
+      w->latency_us[sample++] = (audx_now_ns() - t0) / 1e3f;
+    }
+  }
+
+  pthread_barrier_wait(w->barrier);
+
+  if (states)
+    for (int s = 0; s < cfg->streams_per_thread; s++)
+      audx_destroy(states[s]);
+  free(states);
+  free(out);
+  return NULL;
+}
+
+static void *batch_main(void *arg) {
+  Worker *w = arg;
+  const BenchConfig *cfg = w->config;
+  unsigned int in_len = calculate_frame_sample(cfg->sample_rate);
+  size_t n = in_len * cfg->frames;
+
+  if (cfg->pinning == PIN_COMPACT)
+    pin_thread(pthread_self(), w->index % (int)sysconf(_SC_NPROCESSORS_ONLN));
+
+  short *out = malloc(sizeof(short) * n);
+  if (!out)
+    w->failed = true;
+
+  // The first call creates and warms up the thread's cached state.
+  if (!w->failed && audx_denoise_buffer(NULL, w->input, in_len,
+                                        cfg->sample_rate, AUDX_BUFFER_S16,
+                                        out, NULL) != 0)
+    w->failed = true;
+
+  pthread_barrier_wait(w->barrier);
+
+  size_t sample = 0;
+  for (int s = 0; !w->failed && s < cfg->streams_per_thread; s++) {
+    uint64_t t0 = audx_now_ns();
+    if (audx_denoise_buffer(NULL, w->input, n, cfg->sample_rate,
+                            AUDX_BUFFER_S16, out, NULL) != 0) {
+      w->failed = true;
+      break;
+    }
+    float frame_us = (audx_now_ns() - t0) / 1e3f / cfg->frames;
+    for (size_t f = 0; f < cfg->frames; f++)
+      w->latency_us[sample++] = frame_us;
+  }
+
+  pthread_barrier_wait(w->barrier);
+
+  audx_denoise_buffer_release();
+  free(out);
+  return NULL;
+}
+
+static int compare_float(const void *a, const void *b) {
+  float fa = *(const float *)a, fb = *(const float *)b;
+  return (fa > fb) - (fa < fb);
+}
+
+/**
+ * Loop and batch engines: one thread per worker, each running thread_main on
+ * its own streams.
+ *
+ * @return Steady-state wall time in ns, or 0 on failure.
+ */
+static uint64_t run_threads(const BenchConfig *cfg, const short *input,
+                            float *latency, void *(*thread_main)(void *)) {
+  size_t per_thread = cfg->frames * cfg->streams_per_thread;
+
+  Worker *workers = calloc(cfg->threads, sizeof(Worker));
+  if (!workers)
+    return 0;
+
+  // Main thread joins the barrier to time the steady-state section.
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, cfg->threads + 1);
+
+  for (int t = 0; t < cfg->threads; t++) {
+    workers[t].index = t;
+    workers[t].config = cfg;
+    workers[t].barrier = &barrier;
+    workers[t].input = input;
+    workers[t].latency_us = latency + per_thread * t;
+    pthread_create(&workers[t].thread, NULL, thread_main, &workers[t]);
+  }
+
+  pthread_barrier_wait(&barrier);
+  uint64_t t0 = audx_now_ns();
+  pthread_barrier_wait(&barrier);
+  uint64_t t1 = audx_now_ns();
+
+  bool failed = false;
+  for (int t = 0; t < cfg->threads; t++) {
+    pthread_join(workers[t].thread, NULL);
+    failed |= workers[t].failed;
+  }
+  pthread_barrier_destroy(&barrier);
+
+  free(workers);
+  return failed ? 0 : t1 - t0;
+}
+
+// Completion count for one tick of the pool engine
+typedef struct PoolTick {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int remaining;
+} PoolTick;
+
+typedef struct PoolJob {
+  AudxJob job; // First, so the done callback can cast back
+  PoolTick *tick;
+  uint64_t submit_ns;
+  float *latency_us;
+} PoolJob;
+
+static void pool_job_done(AudxJob *job) {
+  PoolJob *pj = (PoolJob *)job;
+  *pj->latency_us = (audx_now_ns() - pj->submit_ns) / 1e3f;
+
+  pthread_mutex_lock(&pj->tick->lock);
+  if (--pj->tick->remaining == 0)
+    pthread_cond_signal(&pj->tick->cond);
+  pthread_mutex_unlock(&pj->tick->lock);
+}
+
+/**
+ * Pool engine: the calling thread submits every stream's frame for a tick
+ * and waits for the pool to finish them.
+ *
+ * @return Steady-state wall time in ns, or 0 on failure.
+ */
+static uint64_t run_pool(const BenchConfig *cfg, const short *input,
+                         float *latency) {
+  unsigned int in_len = calculate_frame_sample(cfg->sample_rate);
+  int streams = cfg->threads * cfg->streams_per_thread;
+
+  AudxPool *pool = audx_pool_create((unsigned int)cfg->threads);
+  AudxState **states = calloc(streams, sizeof(AudxState *));
+  PoolJob *jobs = calloc(streams, sizeof(PoolJob));
+  short *out = malloc(sizeof(short) * in_len * streams);
+  bool failed = !pool || !states || !jobs || !out;
+
+  // Same placement as the loop engine's threads
+  if (!failed && cfg->pinning == PIN_COMPACT)
+    for (unsigned int t = 0; t < audx_pool_thread_count(pool); t++)
+      pin_thread(audx_pool_thread(pool, t),
+                 (int)t % (int)sysconf(_SC_NPROCESSORS_ONLN));
+
+  for (int s = 0; !failed && s < streams; s++) {
+    states[s] = audx_create(NULL, cfg->sample_rate, cfg->quality);
+    failed = !states[s];
+  }
+
+  PoolTick tick = {.remaining = 0};
+  pthread_mutex_init(&tick.lock, NULL);
+  pthread_cond_init(&tick.cond, NULL);
+
+  uint64_t t0 = audx_now_ns();
+  for (size_t f = 0; !failed && f < cfg->frames; f++) {
+    tick.remaining = streams;
+    for (int s = 0; s < streams; s++) {
+      PoolJob *pj = &jobs[s];
+      pj->job.state = states[s];
+      pj->job.format = AUDX_JOB_S16;
+      pj->job.in = input + f * in_len;
+      pj->job.out = out + (size_t)s * in_len;
+      pj->job.done = pool_job_done;
+      pj->tick = &tick;
+      pj->latency_us = &latency[f * streams + s];
+      pj->submit_ns = audx_now_ns();
+      if (audx_pool_submit(pool, &pj->job) != 0) {
+        // Only the jobs already submitted will complete
+        pthread_mutex_lock(&tick.lock);
+        tick.remaining -= streams - s;
+        pthread_mutex_unlock(&tick.lock);
+        failed = true;
+        break;
+      }
+    }
+
+    pthread_mutex_lock(&tick.lock);
+    while (tick.remaining > 0)
+      pthread_cond_wait(&tick.cond, &tick.lock);
+    pthread_mutex_unlock(&tick.lock);
+  }
+  uint64_t t1 = audx_now_ns();
+
+  audx_pool_destroy(pool);
+  pthread_cond_destroy(&tick.cond);
+  pthread_mutex_destroy(&tick.lock);
+  if (states)
+    for (int s = 0; s < streams; s++)
+      audx_destroy(states[s]);
+  free(states);
+  free(jobs);
+  free(out);
+  return failed ? 0 : t1 - t0;
+}
+
+/**
+ * Run one configuration.
+ *
+ * @return aggregate realtime factor, or a negative value on failure.
+ */
+static double run_config(const BenchConfig *cfg, const short *input,
+                         float *p50_us, float *p99_us, double *wall_s) {
+  size_t total = cfg->frames * cfg->streams_per_thread * cfg->threads;
+  float *latency = malloc(sizeof(float) * total);
+  if (!latency)
+    return -1.0;
+
+  uint64_t wall_ns;
+  if (cfg->engine == ENGINE_POOL)
+    wall_ns = run_pool(cfg, input, latency);
+  else
+    wall_ns = run_threads(cfg, input, latency,
+                          cfg->engine == ENGINE_BATCH ? batch_main
+                                                      : worker_main);
+
+  double rtf = -1.0;
+  if (wall_ns > 0) {
+    qsort(latency, total, sizeof(float), compare_float);
+    *p50_us = latency[total / 2];
+    *p99_us = latency[(size_t)(total * 0.99)];
+    *wall_s = wall_ns / 1e9;
+    double audio_s = total * 0.01;
+    rtf = audio_s / *wall_s;
+  }
+
+  free(latency);
+  return rtf;
+}
+
+// Powers of two up to max_threads, always ending with max_threads itself.
+static int next_thread_count(int threads, int max_threads) {
+  return threads * 2 < max_threads ? threads * 2 : max_threads;
+}
+
+int main(int argc, char **argv) {
+  unsigned int sample_rate = argc > 1 ? atoi(argv[1]) : 16000;
+  size_t frames = argc > 2 ? strtoul(argv[2], NULL, 10) : 500;
+  int nproc = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int max_threads = argc > 3 ? atoi(argv[3]) : nproc;
+
+  unsigned int in_len = calculate_frame_sample(sample_rate);
+  if (in_len == 0 || frames == 0 || max_threads <= 0) {
+    fprintf(stderr,
+            "Usage: %s [sample rate] [frames per stream] [max threads]\n",
+            argv[0]);
+    return 1;
+  }
+
+  // All streams read the same white noise; state is per stream regardless.
+  short *input = malloc(sizeof(short) * in_len * frames);
+  if (!input)
+    return 1;
+  uint32_t seed = 0x12345678u;
+  for (size_t i = 0; i < in_len * frames; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    input[i] = (short)(((int32_t)(seed >> 16) - 32768) / 8);
+  }
+
+  const int streams_per_thread[] = {1, 4, 16, 64};
+  const size_t n_spt = sizeof(streams_per_thread) / sizeof(int);
+
+  printf("engine,threads,streams_per_thread,pinning,frames,wall_s,"
+         "aggregate_rtf,p50_us,p99_us,efficiency\n");
+
+  for (int e = 0; e < ENGINE_COUNT; e++) {
+    for (int p = 0; p < PIN_COUNT; p++) {
+      for (size_t i = 0; i < n_spt; i++) {
+        double single_rtf = 0.0;
+
+        for (int threads = 1;;
+             threads = next_thread_count(threads, max_threads)) {
+          BenchConfig cfg = {
+              .engine = (Engine)e,
+              .sample_rate = sample_rate,
+              .quality = 4,
+              .frames = frames,
+              .threads = threads,
+              .streams_per_thread = streams_per_thread[i],
+              .pinning = (Pinning)p,
+          };
+
+          float p50 = 0.0f, p99 = 0.0f;
+          double wall = 0.0;
+          double rtf = run_config(&cfg, input, &p50, &p99, &wall);
+          if (rtf < 0.0) {
+            fprintf(stderr, "Run failed (engine=%s threads=%d streams=%d)\n",
+                    engine_names[e], threads, streams_per_thread[i]);
+            free(input);
+            return 1;
+          }
+          if (threads == 1)
+            single_rtf = rtf;
+
+          printf("%s,%d,%d,%s,%zu,%.3f,%.1f,%.1f,%.1f,%.3f\n", engine_names[e],
+                 threads, streams_per_thread[i], pinning_names[p], frames, wall,
+                 rtf, p50, p99, rtf / (single_rtf * threads));
+          fflush(stdout);
+
+          if (threads == max_threads)
+            break;
+        }
+      }
+    }
+  }
+
+  free(input);
+  return 0;
+}
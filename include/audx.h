@@ -1,8 +1,22 @@
 #ifndef AUDX_H
 #define AUDX_H
 
+#include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+// SIMD intrinsics for different architectures. SSE4.1 must be enabled by the
+// compiler flags (e.g. -msse4.1 or -march=native), otherwise the portable
+// scalar kernels are used.
+#if defined(__SSE4_1__)
+#include <emmintrin.h> // SSE2
+#include <smmintrin.h> // SSE4.1 for _mm_cvtepi16_epi32
+#define HAS_X86_SIMD 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define HAS_ARM_NEON 1
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -11,6 +25,111 @@ extern "C" {
 #define PCM_SCALE_FLOAT_MAX 32767.0f
 #define PCM_SCALE_FLOAT_MIN -32768.0f
 
+/**
+ * Level metrics accumulated by the metering conversion kernels, in int16
+ * sample units.
+ */
+typedef struct AudxLevelMetrics {
+  float peak;           // Largest absolute sample value
+  float sum_sq;         // Sum of squared samples
+  unsigned int clipped; // Samples at or beyond full scale (clamped on output)
+  unsigned int count;   // Samples metered
+} AudxLevelMetrics;
+
+/**
+ * Per-frame metrics returned by the metered process calls.
+ */
+typedef struct AudxFrameMetrics {
+  float vad_prob;
+  AudxLevelMetrics in;
+  AudxLevelMetrics out;
+} AudxFrameMetrics;
+
+typedef enum AudxBufferFormat {
+  AUDX_BUFFER_S16 = 0,
+  AUDX_BUFFER_F32 = 1,
+} AudxBufferFormat;
+
+/**
+ * One channel of a possibly interleaved buffer: sample i is at
+ * data[i * stride], in `format`. For channel c of an n-channel interleaved
+ * buffer, point data at sample c and set stride to n.
+ */
+typedef struct AudxBufferView {
+  void *data;
+  unsigned int stride; // In samples, >= 1
+  AudxBufferFormat format;
+} AudxBufferView;
+
+static inline float audx_level_rms(const AudxLevelMetrics *m) {
+  return m->count ? sqrtf(m->sum_sq / (float)m->count) : 0.0f;
+}
+
+// Fold per-lane accumulators and a scalar tail into a metrics struct.
+static inline void pcm_meter_finish(AudxLevelMetrics *m, const float *peak4,
+                                    const float *sum4, const uint32_t *clip4,
+                                    float peak, float sum_sq,
+                                    unsigned int clipped, int count) {
+  for (int l = 0; l < 4; l++) {
+    if (peak4[l] > peak)
+      peak = peak4[l];
+    sum_sq += sum4[l];
+    clipped += clip4[l];
+  }
+  m->peak = peak;
+  m->sum_sq = sum_sq;
+  m->clipped = clipped;
+  m->count = (unsigned int)count;
+}
+
+/**
+ * Output stage applied while converting float to int16: linear gain, a
+ * lookahead-free soft-knee limiter and TPDF dither. Set up per state with
+ * audx_set_output_stage(); the fields are precomputed for the kernels.
+ */
+typedef struct AudxOutputStage {
+  float gain;      // Linear gain, applied first
+  float threshold; // Limiter knee start, in int16 units
+  float inv_range; // 1 / (ceiling - threshold); 0 leaves the signal linear
+  float dither;    // TPDF peak amplitude in LSB; 0 disables dither
+  uint32_t rng[4]; // Per-lane xorshift32 state, never zero
+} AudxOutputStage;
+
+static inline uint32_t pcm_xorshift32(uint32_t *s) {
+  uint32_t x = *s;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *s = x;
+  return x;
+}
+
+/**
+ * Scalar reference of the output stage for one sample. Above the threshold
+ * the limiter maps the excess d to d / (1 + d / (ceiling - threshold)), which
+ * has unit slope at the knee and approaches the ceiling asymptotically. The
+ * dither is the difference of two 16-bit uniforms taken from one draw.
+ */
+static inline short pcm_output_sample(float x, const AudxOutputStage *stage,
+                                      uint32_t *rng) {
+  x *= stage->gain;
+  float a = fabsf(x);
+  float d = a > stage->threshold ? a - stage->threshold : 0.0f;
+  a = (a < stage->threshold ? a : stage->threshold) +
+      d / (1.0f + d * stage->inv_range);
+  x = copysignf(a, x);
+
+  uint32_t r = pcm_xorshift32(rng);
+  x += (float)((int32_t)(r & 0xffff) - (int32_t)(r >> 16)) *
+       (1.0f / 65536.0f) * stage->dither;
+
+  if (x > PCM_SCALE_FLOAT_MAX)
+    x = PCM_SCALE_FLOAT_MAX;
+  if (x < PCM_SCALE_FLOAT_MIN)
+    x = PCM_SCALE_FLOAT_MIN;
+  return (short)lrintf(x);
+}
+
 #ifdef HAS_X86_SIMD
 // SSE4.1-optimized int16 to float conversion
 static inline void pcm_int16_to_float(const short *input, float *output,
@@ -69,6 +188,241 @@ static inline void pcm_float_to_int16(const float *input, short *output,
   }
 }
 
+// SSE4.1 int16 to float conversion with fused level metering
+static inline void pcm_int16_to_float_meter(const short *input, float *output,
+                                            int count, AudxLevelMetrics *m) {
+  int i = 0;
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 full_scale = _mm_set1_ps(PCM_SCALE_FLOAT_MAX);
+  __m128 vpeak = _mm_setzero_ps();
+  __m128 vsum = _mm_setzero_ps();
+  __m128i vclip = _mm_setzero_si128();
+
+  for (; i <= count - 8; i += 8) {
+    __m128i in16 = _mm_loadu_si128((__m128i *)&input[i]);
+    __m128 flo = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(in16));
+    __m128 fhi = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(in16, 8)));
+    _mm_storeu_ps(&output[i], flo);
+    _mm_storeu_ps(&output[i + 4], fhi);
+
+    __m128 alo = _mm_and_ps(flo, abs_mask);
+    __m128 ahi = _mm_and_ps(fhi, abs_mask);
+    vpeak = _mm_max_ps(vpeak, _mm_max_ps(alo, ahi));
+    vsum = _mm_add_ps(vsum, _mm_add_ps(_mm_mul_ps(flo, flo),
+                                       _mm_mul_ps(fhi, fhi)));
+    // Compare masks are -1 per lane, so subtracting counts hits.
+    vclip = _mm_sub_epi32(vclip,
+                          _mm_castps_si128(_mm_cmpge_ps(alo, full_scale)));
+    vclip = _mm_sub_epi32(vclip,
+                          _mm_castps_si128(_mm_cmpge_ps(ahi, full_scale)));
+  }
+
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (; i < count; i++) {
+    float v = (float)input[i];
+    float a = fabsf(v);
+    output[i] = v;
+    peak = a > peak ? a : peak;
+    sum_sq += v * v;
+    clipped += a >= PCM_SCALE_FLOAT_MAX;
+  }
+
+  float peak4[4], sum4[4];
+  uint32_t clip4[4];
+  _mm_storeu_ps(peak4, vpeak);
+  _mm_storeu_ps(sum4, vsum);
+  _mm_storeu_si128((__m128i *)clip4, vclip);
+  pcm_meter_finish(m, peak4, sum4, clip4, peak, sum_sq, clipped, count);
+}
+
+// SSE4.1 float to int16 conversion with clamping and fused level metering
+static inline void pcm_float_to_int16_meter(const float *input, short *output,
+                                            int count, AudxLevelMetrics *m) {
+  int i = 0;
+  const __m128 max_val = _mm_set1_ps(PCM_SCALE_FLOAT_MAX);
+  const __m128 min_val = _mm_set1_ps(PCM_SCALE_FLOAT_MIN);
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 vpeak = _mm_setzero_ps();
+  __m128 vsum = _mm_setzero_ps();
+  __m128i vclip = _mm_setzero_si128();
+
+  for (; i <= count - 8; i += 8) {
+    __m128 flo = _mm_loadu_ps(&input[i]);
+    __m128 fhi = _mm_loadu_ps(&input[i + 4]);
+    __m128 olo = _mm_or_ps(_mm_cmpgt_ps(flo, max_val),
+                           _mm_cmplt_ps(flo, min_val));
+    __m128 ohi = _mm_or_ps(_mm_cmpgt_ps(fhi, max_val),
+                           _mm_cmplt_ps(fhi, min_val));
+    vclip = _mm_sub_epi32(vclip, _mm_castps_si128(olo));
+    vclip = _mm_sub_epi32(vclip, _mm_castps_si128(ohi));
+
+    flo = _mm_min_ps(_mm_max_ps(flo, min_val), max_val);
+    fhi = _mm_min_ps(_mm_max_ps(fhi, min_val), max_val);
+    vpeak = _mm_max_ps(vpeak, _mm_max_ps(_mm_and_ps(flo, abs_mask),
+                                         _mm_and_ps(fhi, abs_mask)));
+    vsum = _mm_add_ps(vsum, _mm_add_ps(_mm_mul_ps(flo, flo),
+                                       _mm_mul_ps(fhi, fhi)));
+
+    __m128i packed =
+        _mm_packs_epi32(_mm_cvtps_epi32(flo), _mm_cvtps_epi32(fhi));
+    _mm_storeu_si128((__m128i *)&output[i], packed);
+  }
+
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (; i < count; i++) {
+    float val = input[i];
+    if (val > PCM_SCALE_FLOAT_MAX || val < PCM_SCALE_FLOAT_MIN)
+      clipped++;
+    if (val > PCM_SCALE_FLOAT_MAX)
+      val = PCM_SCALE_FLOAT_MAX;
+    if (val < PCM_SCALE_FLOAT_MIN)
+      val = PCM_SCALE_FLOAT_MIN;
+    output[i] = (int16_t)val;
+    peak = fabsf(val) > peak ? fabsf(val) : peak;
+    sum_sq += val * val;
+  }
+
+  float peak4[4], sum4[4];
+  uint32_t clip4[4];
+  _mm_storeu_ps(peak4, vpeak);
+  _mm_storeu_ps(sum4, vsum);
+  _mm_storeu_si128((__m128i *)clip4, vclip);
+  pcm_meter_finish(m, peak4, sum4, clip4, peak, sum_sq, clipped, count);
+}
+
+// SSE level metering for float paths that need no conversion
+static inline void pcm_float_meter(const float *input, int count,
+                                   AudxLevelMetrics *m) {
+  int i = 0;
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 full_scale = _mm_set1_ps(PCM_SCALE_FLOAT_MAX);
+  __m128 vpeak = _mm_setzero_ps();
+  __m128 vsum = _mm_setzero_ps();
+  __m128i vclip = _mm_setzero_si128();
+
+  for (; i <= count - 4; i += 4) {
+    __m128 f = _mm_loadu_ps(&input[i]);
+    __m128 a = _mm_and_ps(f, abs_mask);
+    vpeak = _mm_max_ps(vpeak, a);
+    vsum = _mm_add_ps(vsum, _mm_mul_ps(f, f));
+    vclip = _mm_sub_epi32(vclip, _mm_castps_si128(_mm_cmpge_ps(a, full_scale)));
+  }
+
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (; i < count; i++) {
+    float a = fabsf(input[i]);
+    peak = a > peak ? a : peak;
+    sum_sq += input[i] * input[i];
+    clipped += a >= PCM_SCALE_FLOAT_MAX;
+  }
+
+  float peak4[4], sum4[4];
+  uint32_t clip4[4];
+  _mm_storeu_ps(peak4, vpeak);
+  _mm_storeu_ps(sum4, vsum);
+  _mm_storeu_si128((__m128i *)clip4, vclip);
+  pcm_meter_finish(m, peak4, sum4, clip4, peak, sum_sq, clipped, count);
+}
+
+static inline __m128 pcm_tpdf_sse(__m128i *rng) {
+  __m128i x = *rng;
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+  *rng = x;
+
+  __m128i lo = _mm_and_si128(x, _mm_set1_epi32(0xffff));
+  __m128i hi = _mm_srli_epi32(x, 16);
+  return _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(lo, hi)),
+                    _mm_set1_ps(1.0f / 65536.0f));
+}
+
+static inline __m128 pcm_soft_limit_sse(__m128 x, __m128 threshold,
+                                        __m128 inv_range) {
+  const __m128 sign_mask = _mm_set1_ps(-0.0f);
+  __m128 sign = _mm_and_ps(x, sign_mask);
+  __m128 a = _mm_andnot_ps(sign_mask, x);
+  __m128 d = _mm_max_ps(_mm_sub_ps(a, threshold), _mm_setzero_ps());
+  __m128 den = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(d, inv_range));
+
+  // Reciprocal estimate plus one Newton step, much cheaper than a divide.
+  __m128 r = _mm_rcp_ps(den);
+  r = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(den, r)));
+  __m128 knee = _mm_mul_ps(d, r);
+  return _mm_or_ps(_mm_add_ps(_mm_min_ps(a, threshold), knee), sign);
+}
+
+// SSE4.1 float to int16 conversion through the output stage
+static inline void pcm_float_to_int16_stage(const float *input, short *output,
+                                            int count,
+                                            AudxOutputStage *stage) {
+  int i = 0;
+  const __m128 max_val = _mm_set1_ps(PCM_SCALE_FLOAT_MAX);
+  const __m128 min_val = _mm_set1_ps(PCM_SCALE_FLOAT_MIN);
+  const __m128 gain = _mm_set1_ps(stage->gain);
+  const __m128 threshold = _mm_set1_ps(stage->threshold);
+  const __m128 inv_range = _mm_set1_ps(stage->inv_range);
+  const __m128 dither = _mm_set1_ps(stage->dither);
+  __m128i rng = _mm_loadu_si128((const __m128i *)stage->rng);
+
+  for (; i <= count - 8; i += 8) {
+    __m128 flo = _mm_mul_ps(_mm_loadu_ps(&input[i]), gain);
+    __m128 fhi = _mm_mul_ps(_mm_loadu_ps(&input[i + 4]), gain);
+
+    flo = pcm_soft_limit_sse(flo, threshold, inv_range);
+    fhi = pcm_soft_limit_sse(fhi, threshold, inv_range);
+    flo = _mm_add_ps(flo, _mm_mul_ps(pcm_tpdf_sse(&rng), dither));
+    fhi = _mm_add_ps(fhi, _mm_mul_ps(pcm_tpdf_sse(&rng), dither));
+
+    flo = _mm_min_ps(_mm_max_ps(flo, min_val), max_val);
+    fhi = _mm_min_ps(_mm_max_ps(fhi, min_val), max_val);
+
+    // _mm_cvtps_epi32 rounds to nearest, as dither requires
+    __m128i packed =
+        _mm_packs_epi32(_mm_cvtps_epi32(flo), _mm_cvtps_epi32(fhi));
+    _mm_storeu_si128((__m128i *)&output[i], packed);
+  }
+
+  _mm_storeu_si128((__m128i *)stage->rng, rng);
+  for (; i < count; i++)
+    output[i] = pcm_output_sample(input[i], stage, &stage->rng[0]);
+}
+
+// SSE4.1 gather of every stride-th int16 sample to float. Stereo channels
+// sign-extend the low half of each 32-bit lane; other strides are scalar.
+static inline void pcm_int16_to_float_strided(const short *input, int stride,
+                                              float *output, int count) {
+  int i = 0;
+  if (stride == 2) {
+    // Stop one frame early so loads never pass the channel's last sample
+    for (; i + 4 < count; i += 4) {
+      __m128i in16 = _mm_loadu_si128((const __m128i *)&input[2 * i]);
+      __m128i lo32 = _mm_srai_epi32(_mm_slli_epi32(in16, 16), 16);
+      _mm_storeu_ps(&output[i], _mm_cvtepi32_ps(lo32));
+    }
+  }
+  for (; i < count; i++)
+    output[i] = (float)input[(long)i * stride];
+}
+
+// SSE gather of every stride-th float sample
+static inline void pcm_float_strided(const float *input, int stride,
+                                     float *output, int count) {
+  int i = 0;
+  if (stride == 2) {
+    for (; i + 4 < count; i += 4) {
+      __m128 a = _mm_loadu_ps(&input[2 * i]);
+      __m128 b = _mm_loadu_ps(&input[2 * i + 4]);
+      _mm_storeu_ps(&output[i], _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+  }
+  for (; i < count; i++)
+    output[i] = input[(long)i * stride];
+}
+
 #elif defined(HAS_ARM_NEON)
 // ARM NEON-optimized int16 to float conversion
 static inline void pcm_int16_to_float(const short *input, float *output,
@@ -128,6 +482,238 @@ static inline void pcm_float_to_int16(const float *input, short *output,
   }
 }
 
+// ARM NEON int16 to float conversion with fused level metering
+static inline void pcm_int16_to_float_meter(const short *input, float *output,
+                                            int count, AudxLevelMetrics *m) {
+  int i = 0;
+  const float32x4_t full_scale = vdupq_n_f32(PCM_SCALE_FLOAT_MAX);
+  float32x4_t vpeak = vdupq_n_f32(0.0f);
+  float32x4_t vsum = vdupq_n_f32(0.0f);
+  uint32x4_t vclip = vdupq_n_u32(0);
+
+  for (; i <= count - 8; i += 8) {
+    int16x8_t in16 = vld1q_s16(&input[i]);
+    float32x4_t flo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(in16)));
+    float32x4_t fhi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(in16)));
+    vst1q_f32(&output[i], flo);
+    vst1q_f32(&output[i + 4], fhi);
+
+    float32x4_t alo = vabsq_f32(flo);
+    float32x4_t ahi = vabsq_f32(fhi);
+    vpeak = vmaxq_f32(vpeak, vmaxq_f32(alo, ahi));
+    vsum = vmlaq_f32(vsum, flo, flo);
+    vsum = vmlaq_f32(vsum, fhi, fhi);
+    // Compare masks are all ones per lane, so subtracting counts hits.
+    vclip = vsubq_u32(vclip, vcgeq_f32(alo, full_scale));
+    vclip = vsubq_u32(vclip, vcgeq_f32(ahi, full_scale));
+  }
+
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (; i < count; i++) {
+    float v = (float)input[i];
+    float a = fabsf(v);
+    output[i] = v;
+    peak = a > peak ? a : peak;
+    sum_sq += v * v;
+    clipped += a >= PCM_SCALE_FLOAT_MAX;
+  }
+
+  float peak4[4], sum4[4];
+  uint32_t clip4[4];
+  vst1q_f32(peak4, vpeak);
+  vst1q_f32(sum4, vsum);
+  vst1q_u32(clip4, vclip);
+  pcm_meter_finish(m, peak4, sum4, clip4, peak, sum_sq, clipped, count);
+}
+
+// ARM NEON float to int16 conversion with clamping and fused level metering
+static inline void pcm_float_to_int16_meter(const float *input, short *output,
+                                            int count, AudxLevelMetrics *m) {
+  int i = 0;
+  const float32x4_t max_val = vdupq_n_f32(PCM_SCALE_FLOAT_MAX);
+  const float32x4_t min_val = vdupq_n_f32(PCM_SCALE_FLOAT_MIN);
+  float32x4_t vpeak = vdupq_n_f32(0.0f);
+  float32x4_t vsum = vdupq_n_f32(0.0f);
+  uint32x4_t vclip = vdupq_n_u32(0);
+
+  for (; i <= count - 8; i += 8) {
+    float32x4_t flo = vld1q_f32(&input[i]);
+    float32x4_t fhi = vld1q_f32(&input[i + 4]);
+    vclip = vsubq_u32(vclip, vorrq_u32(vcgtq_f32(flo, max_val),
+                                       vcltq_f32(flo, min_val)));
+    vclip = vsubq_u32(vclip, vorrq_u32(vcgtq_f32(fhi, max_val),
+                                       vcltq_f32(fhi, min_val)));
+
+    flo = vminq_f32(vmaxq_f32(flo, min_val), max_val);
+    fhi = vminq_f32(vmaxq_f32(fhi, min_val), max_val);
+    vpeak = vmaxq_f32(vpeak, vmaxq_f32(vabsq_f32(flo), vabsq_f32(fhi)));
+    vsum = vmlaq_f32(vsum, flo, flo);
+    vsum = vmlaq_f32(vsum, fhi, fhi);
+
+    int16x4_t lo16 = vmovn_s32(vcvtq_s32_f32(flo));
+    int16x4_t hi16 = vmovn_s32(vcvtq_s32_f32(fhi));
+    vst1q_s16(&output[i], vcombine_s16(lo16, hi16));
+  }
+
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (; i < count; i++) {
+    float val = input[i];
+    if (val > PCM_SCALE_FLOAT_MAX || val < PCM_SCALE_FLOAT_MIN)
+      clipped++;
+    if (val > PCM_SCALE_FLOAT_MAX)
+      val = PCM_SCALE_FLOAT_MAX;
+    if (val < PCM_SCALE_FLOAT_MIN)
+      val = PCM_SCALE_FLOAT_MIN;
+    output[i] = (int16_t)val;
+    peak = fabsf(val) > peak ? fabsf(val) : peak;
+    sum_sq += val * val;
+  }
+
+  float peak4[4], sum4[4];
+  uint32_t clip4[4];
+  vst1q_f32(peak4, vpeak);
+  vst1q_f32(sum4, vsum);
+  vst1q_u32(clip4, vclip);
+  pcm_meter_finish(m, peak4, sum4, clip4, peak, sum_sq, clipped, count);
+}
+
+// ARM NEON level metering for float paths that need no conversion
+static inline void pcm_float_meter(const float *input, int count,
+                                   AudxLevelMetrics *m) {
+  int i = 0;
+  const float32x4_t full_scale = vdupq_n_f32(PCM_SCALE_FLOAT_MAX);
+  float32x4_t vpeak = vdupq_n_f32(0.0f);
+  float32x4_t vsum = vdupq_n_f32(0.0f);
+  uint32x4_t vclip = vdupq_n_u32(0);
+
+  for (; i <= count - 4; i += 4) {
+    float32x4_t f = vld1q_f32(&input[i]);
+    float32x4_t a = vabsq_f32(f);
+    vpeak = vmaxq_f32(vpeak, a);
+    vsum = vmlaq_f32(vsum, f, f);
+    vclip = vsubq_u32(vclip, vcgeq_f32(a, full_scale));
+  }
+
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (; i < count; i++) {
+    float a = fabsf(input[i]);
+    peak = a > peak ? a : peak;
+    sum_sq += input[i] * input[i];
+    clipped += a >= PCM_SCALE_FLOAT_MAX;
+  }
+
+  float peak4[4], sum4[4];
+  uint32_t clip4[4];
+  vst1q_f32(peak4, vpeak);
+  vst1q_f32(sum4, vsum);
+  vst1q_u32(clip4, vclip);
+  pcm_meter_finish(m, peak4, sum4, clip4, peak, sum_sq, clipped, count);
+}
+
+static inline float32x4_t pcm_tpdf_neon(uint32x4_t *rng) {
+  uint32x4_t x = *rng;
+  x = veorq_u32(x, vshlq_n_u32(x, 13));
+  x = veorq_u32(x, vshrq_n_u32(x, 17));
+  x = veorq_u32(x, vshlq_n_u32(x, 5));
+  *rng = x;
+
+  int32x4_t lo = vreinterpretq_s32_u32(vandq_u32(x, vdupq_n_u32(0xffff)));
+  int32x4_t hi = vreinterpretq_s32_u32(vshrq_n_u32(x, 16));
+  return vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(lo, hi)), 1.0f / 65536.0f);
+}
+
+static inline float32x4_t pcm_soft_limit_neon(float32x4_t x,
+                                              float32x4_t threshold,
+                                              float32x4_t inv_range) {
+  const uint32x4_t sign_mask = vdupq_n_u32(0x80000000u);
+  uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(x), sign_mask);
+  float32x4_t a = vabsq_f32(x);
+  float32x4_t d = vmaxq_f32(vsubq_f32(a, threshold), vdupq_n_f32(0.0f));
+  float32x4_t den = vmlaq_f32(vdupq_n_f32(1.0f), d, inv_range);
+
+  // Reciprocal estimate refined twice; ARMv7 has no vector divide.
+  float32x4_t r = vrecpeq_f32(den);
+  r = vmulq_f32(r, vrecpsq_f32(den, r));
+  r = vmulq_f32(r, vrecpsq_f32(den, r));
+
+  float32x4_t y = vmlaq_f32(vminq_f32(a, threshold), d, r);
+  return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(y), sign));
+}
+
+// Round to nearest: vcvtq_s32_f32 truncates, so add a signed half first
+static inline int32x4_t pcm_round_neon(float32x4_t x) {
+  uint32x4_t sign =
+      vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x80000000u));
+  float32x4_t half = vreinterpretq_f32_u32(
+      vorrq_u32(vreinterpretq_u32_f32(vdupq_n_f32(0.5f)), sign));
+  return vcvtq_s32_f32(vaddq_f32(x, half));
+}
+
+// ARM NEON float to int16 conversion through the output stage
+static inline void pcm_float_to_int16_stage(const float *input, short *output,
+                                            int count,
+                                            AudxOutputStage *stage) {
+  int i = 0;
+  const float32x4_t max_val = vdupq_n_f32(PCM_SCALE_FLOAT_MAX);
+  const float32x4_t min_val = vdupq_n_f32(PCM_SCALE_FLOAT_MIN);
+  const float32x4_t threshold = vdupq_n_f32(stage->threshold);
+  const float32x4_t inv_range = vdupq_n_f32(stage->inv_range);
+  uint32x4_t rng = vld1q_u32(stage->rng);
+
+  for (; i <= count - 8; i += 8) {
+    float32x4_t flo = vmulq_n_f32(vld1q_f32(&input[i]), stage->gain);
+    float32x4_t fhi = vmulq_n_f32(vld1q_f32(&input[i + 4]), stage->gain);
+
+    flo = pcm_soft_limit_neon(flo, threshold, inv_range);
+    fhi = pcm_soft_limit_neon(fhi, threshold, inv_range);
+    flo = vmlaq_n_f32(flo, pcm_tpdf_neon(&rng), stage->dither);
+    fhi = vmlaq_n_f32(fhi, pcm_tpdf_neon(&rng), stage->dither);
+
+    flo = vminq_f32(vmaxq_f32(flo, min_val), max_val);
+    fhi = vminq_f32(vmaxq_f32(fhi, min_val), max_val);
+
+    int16x4_t lo16 = vqmovn_s32(pcm_round_neon(flo));
+    int16x4_t hi16 = vqmovn_s32(pcm_round_neon(fhi));
+    vst1q_s16(&output[i], vcombine_s16(lo16, hi16));
+  }
+
+  vst1q_u32(stage->rng, rng);
+  for (; i < count; i++)
+    output[i] = pcm_output_sample(input[i], stage, &stage->rng[0]);
+}
+
+// NEON gather of every stride-th int16 sample to float. Stereo channels use
+// a deinterleaving load; other strides are scalar.
+static inline void pcm_int16_to_float_strided(const short *input, int stride,
+                                              float *output, int count) {
+  int i = 0;
+  if (stride == 2) {
+    // Stop one frame early so loads never pass the channel's last sample
+    for (; i + 8 < count; i += 8) {
+      int16x8_t in16 = vld2q_s16(&input[2 * i]).val[0];
+      vst1q_f32(&output[i], vcvtq_f32_s32(vmovl_s16(vget_low_s16(in16))));
+      vst1q_f32(&output[i + 4], vcvtq_f32_s32(vmovl_s16(vget_high_s16(in16))));
+    }
+  }
+  for (; i < count; i++)
+    output[i] = (float)input[(long)i * stride];
+}
+
+// NEON gather of every stride-th float sample
+static inline void pcm_float_strided(const float *input, int stride,
+                                     float *output, int count) {
+  int i = 0;
+  if (stride == 2) {
+    for (; i + 4 < count; i += 4)
+      vst1q_f32(&output[i], vld2q_f32(&input[2 * i]).val[0]);
+  }
+  for (; i < count; i++)
+    output[i] = input[(long)i * stride];
+}
+
 #else
 // Scalar fallback for platforms without SIMD
 static inline void pcm_int16_to_float(const short *input, float *output,
@@ -147,6 +733,78 @@ static inline void pcm_float_to_int16(const float *input, short *output,
     output[i] = (int16_t)val;
   }
 }
+static inline void pcm_int16_to_float_meter(const short *input, float *output,
+                                            int count, AudxLevelMetrics *m) {
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (int i = 0; i < count; i++) {
+    float v = (float)input[i];
+    float a = fabsf(v);
+    output[i] = v;
+    peak = a > peak ? a : peak;
+    sum_sq += v * v;
+    clipped += a >= PCM_SCALE_FLOAT_MAX;
+  }
+  m->peak = peak;
+  m->sum_sq = sum_sq;
+  m->clipped = clipped;
+  m->count = (unsigned int)count;
+}
+
+static inline void pcm_float_to_int16_meter(const float *input, short *output,
+                                            int count, AudxLevelMetrics *m) {
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (int i = 0; i < count; i++) {
+    float val = input[i];
+    if (val > PCM_SCALE_FLOAT_MAX || val < PCM_SCALE_FLOAT_MIN)
+      clipped++;
+    if (val > PCM_SCALE_FLOAT_MAX)
+      val = PCM_SCALE_FLOAT_MAX;
+    if (val < PCM_SCALE_FLOAT_MIN)
+      val = PCM_SCALE_FLOAT_MIN;
+    output[i] = (int16_t)val;
+    peak = fabsf(val) > peak ? fabsf(val) : peak;
+    sum_sq += val * val;
+  }
+  m->peak = peak;
+  m->sum_sq = sum_sq;
+  m->clipped = clipped;
+  m->count = (unsigned int)count;
+}
+
+static inline void pcm_float_meter(const float *input, int count,
+                                   AudxLevelMetrics *m) {
+  float peak = 0.0f, sum_sq = 0.0f;
+  unsigned int clipped = 0;
+  for (int i = 0; i < count; i++) {
+    float a = fabsf(input[i]);
+    peak = a > peak ? a : peak;
+    sum_sq += input[i] * input[i];
+    clipped += a >= PCM_SCALE_FLOAT_MAX;
+  }
+  m->peak = peak;
+  m->sum_sq = sum_sq;
+  m->clipped = clipped;
+  m->count = (unsigned int)count;
+}
+static inline void pcm_float_to_int16_stage(const float *input, short *output,
+                                            int count,
+                                            AudxOutputStage *stage) {
+  for (int i = 0; i < count; i++)
+    output[i] = pcm_output_sample(input[i], stage, &stage->rng[i & 3]);
+}
+static inline void pcm_int16_to_float_strided(const short *input, int stride,
+                                              float *output, int count) {
+  for (int i = 0; i < count; i++)
+    output[i] = (float)input[(long)i * stride];
+}
+
+static inline void pcm_float_strided(const float *input, int stride,
+                                     float *output, int count) {
+  for (int i = 0; i < count; i++)
+    output[i] = input[(long)i * stride];
+}
 #endif
 
 // RNNoise requires 48Khz input and output
@@ -164,8 +822,176 @@ float audx_process(AudxState *state, float *in, float *out);
 
 float audx_process_int(AudxState *state, short *in, short *out);
 
+/**
+ * Process a frame between buffer views, so one channel of an interleaved
+ * buffer can be denoised without deinterleaving it first. The input is
+ * gathered straight into the pipeline and the output scattered back; only
+ * the samples of the viewed channel are written. in and out may use
+ * different formats and strides, and may view the same samples. S16 output
+ * goes through the output stage like audx_process_int().
+ *
+ * @return The probability of speech, or -1 on error.
+ */
+float audx_process_view(AudxState *state, const AudxBufferView *in,
+                        const AudxBufferView *out);
+
+/**
+ * Run synthetic frames through the full pipeline, then reset the denoiser
+ * and resamplers so the next real frame starts from the same state as a
+ * freshly created one, but with warm caches and touched buffers.
+ *
+ * Warm-up frames are not captured, published to telemetry or charged to a
+ * tenant, and the frame counter restarts at 0. Call it before the stream
+ * starts, from the thread that will process it.
+ *
+ * @param nframes   Synthetic 10ms frames to run; 0 picks a default.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_warmup(AudxState *state, unsigned int nframes);
+
+/**
+ * Return a state to the condition of a freshly created one: denoiser and
+ * resampler history cleared, dither reseeded and the frame counter at 0.
+ * Configuration (output stage, ASRC ratio, capture, tenant) is kept.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_reset(AudxState *state);
+
+/**
+ * Delay from input to output of audx_process() and its variants, in samples
+ * at the input rate: one denoiser frame plus the resampler group delay when
+ * resampling. See audx_asrc_latency() for drift-corrected output.
+ */
+unsigned int audx_latency(const AudxState *state);
+
+/**
+ * Configure the output stage fused into the float to int16 conversion of
+ * audx_process_int() and its variants. The float API is not affected.
+ *
+ * @param gain_db       Makeup gain applied before limiting.
+ * @param ceiling_dbfs  Level the limiter approaches but never exceeds, <= 0.
+ * @param knee_db       Distance of the knee below the ceiling. The limiter is
+ *                      linear up to the knee and soft above it; 0 disables
+ *                      it, leaving only the hard clamp at full scale.
+ * @param dither        Add +/-1 LSB TPDF dither before rounding.
+ *
+ * Passing 0, 0, 0, false restores the plain conversion.
+ *
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int audx_set_output_stage(AudxState *state, float gain_db, float ceiling_dbfs,
+                          float knee_db, bool dither);
+
+/**
+ * Process a frame and meter input and output levels in the same pass as the
+ * PCM conversion. Input is metered before denoising, output after.
+ *
+ * @param metrics   Receives the VAD value and level metrics of this frame.
+ *
+ * @return The probability of speech, or -1 on error.
+ */
+float audx_process_metered(AudxState *state, float *in, float *out,
+                           AudxFrameMetrics *metrics);
+
+float audx_process_int_metered(AudxState *state, short *in, short *out,
+                               AudxFrameMetrics *metrics);
+
 void audx_destroy(AudxState *state);
 
+/* --- Asynchronous sample rate conversion (clock drift) --- */
+
+// Extra output samples a drift-corrected frame may produce
+#define AUDX_ASRC_MAX_EXTRA 2
+
+/**
+ * Enable drift-corrected output.
+ *
+ * The downsampler ratio becomes adjustable by up to +/- max_ppm around the
+ * nominal rate. All resampler memory is sized for both extremes here, so
+ * later ratio updates never reallocate.
+ *
+ * The extra samples of a frame must fit in AUDX_ASRC_MAX_EXTRA, which bounds
+ * max_ppm to (AUDX_ASRC_MAX_EXTRA - 1) * 1e6 / calculate_frame_sample(in_rate):
+ * about 2000 ppm at 48kHz and 500 ppm at 192kHz.
+ *
+ * @return 0 on success, -1 on error or when max_ppm is out of range.
+ */
+int audx_asrc_enable(AudxState *state, double max_ppm);
+
+/**
+ * Fill-level control loop.
+ *
+ * Call once per frame with the current depth of the output (playback) buffer
+ * and the desired depth, both in samples at the input rate. A PI controller
+ * steers the output ratio so the buffer converges to the target.
+ *
+ * @return The applied correction in ppm (positive = fewer output samples).
+ */
+double audx_asrc_update(AudxState *state, int fill_level, int target_fill);
+
+/**
+ * Set the output ratio correction directly, e.g. from a timestamp-based
+ * clock estimator. Clamped to +/- max_ppm.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_asrc_set_ppm(AudxState *state, double ppm);
+
+/**
+ * Process one frame with drift correction.
+ *
+ * @param out       Must hold calculate_frame_sample(in_rate) +
+ *                  AUDX_ASRC_MAX_EXTRA samples.
+ * @param out_len   Receives the number of samples written.
+ *
+ * @return The probability of speech, or -1 on error.
+ */
+float audx_process_asrc(AudxState *state, float *in, float *out,
+                        unsigned int *out_len);
+
+/**
+ * Delay of audx_process_asrc(), in samples at the input rate. Same as
+ * audx_latency() except at the native rate, where it adds the downsampler
+ * audx_asrc_enable() created.
+ */
+unsigned int audx_asrc_latency(const AudxState *state);
+
+float audx_process_asrc_int(AudxState *state, short *in, short *out,
+                            unsigned int *out_len);
+
+/* --- Acoustic echo cancellation --- */
+
+// Echo tail covered when audx_aec_enable() is given 0
+#define AUDX_AEC_DEFAULT_TAIL_MS 200
+
+/**
+ * Enable echo cancellation ahead of the denoiser.
+ *
+ * The SpeexDSP echo canceller runs on the denoiser's 10ms frames at its
+ * native rate, so the near end is resampled and framed once for both
+ * stages. The far-end reference gets one resampler of its own.
+ *
+ * @param tail_ms   Longest echo path to cancel; 0 picks the default.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_aec_enable(AudxState *state, unsigned int tail_ms);
+
+/**
+ * Process one frame with its far-end reference: the in_len samples at the
+ * input rate that were played out while `in` was captured. Frames processed
+ * through the other calls use a silent reference.
+ *
+ * @return The probability of speech, or -1 on error or when AEC is off.
+ */
+float audx_process_aec(AudxState *state, float *in, const float *far,
+                       float *out);
+
+float audx_process_aec_int(AudxState *state, short *in, const short *far,
+                           short *out);
+
 #ifdef __cplusplus
 }
 #endif
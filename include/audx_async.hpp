@@ -0,0 +1,288 @@
+#ifndef AUDX_ASYNC_HPP
+#define AUDX_ASYNC_HPP
+
+/*
+ * C++20 coroutine front end for the worker pool (audx_pool.h).
+ *
+ *   audx::async_denoiser den(pool, state, my_executor);
+ *   float vad = co_await den.process(in, out);
+ *
+ * The AudxJob lives inside the awaiter, which lives in the coroutine frame,
+ * so awaiting a frame never allocates. Coroutine frames themselves can come
+ * from frame_allocator by deriving the promise from recycled_frame, as
+ * detached_task does. The coroutine is resumed through the executor's
+ * post(); inline_executor resumes it directly on the pool worker.
+ */
+
+#include "audx_pool.h"
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace audx {
+
+// Executors are copied once per completed frame, so they should be handles.
+template <class E>
+concept executor = std::copy_constructible<E> &&
+                   requires(E &e, std::coroutine_handle<> h) { e.post(h); };
+
+struct inline_executor {
+  void post(std::coroutine_handle<> h) const { h.resume(); }
+};
+
+/**
+ * Recycling allocator for coroutine frames. Each thread keeps a free list per
+ * 64-byte size class, and a freed block always goes back to the thread that
+ * allocated it: a frame freed elsewhere, e.g. on the pool worker that
+ * resumed it through inline_executor, is pushed onto a lock-free list that
+ * the owner takes over on its next allocation of that size. Larger frames
+ * use the global heap.
+ */
+class frame_allocator {
+public:
+  static void *allocate(std::size_t size) {
+    std::size_t cls = size_class(size);
+    if (cls >= classes) {
+      auto *block =
+          static_cast<header *>(::operator new(size + sizeof(header)));
+      block->owner = nullptr;
+      return block + 1;
+    }
+
+    free_lists *owner = local();
+    header *block = owner->pop(cls);
+    if (!block)
+      block = static_cast<header *>(::operator new((cls + 1) * granule));
+    owner->refs.fetch_add(1, std::memory_order_relaxed);
+    block->owner = owner;
+    return block + 1;
+  }
+
+  static void deallocate(void *ptr, std::size_t size) noexcept {
+    header *block = static_cast<header *>(ptr) - 1;
+    free_lists *owner = block->owner;
+    if (!owner) {
+      ::operator delete(block);
+      return;
+    }
+
+    std::size_t cls = size_class(size);
+    if (owner == current)
+      owner->push(cls, block);
+    else
+      owner->push_remote(cls, block);
+    owner->release();
+  }
+
+private:
+  static constexpr std::size_t granule = 64;
+  static constexpr std::size_t classes = 64; // Frames up to 4 KiB
+
+  struct free_lists;
+
+  // Keeps frames at operator new's alignment
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) header {
+    union {
+      free_lists *owner; // While in use
+      header *next;      // While on a free list
+    };
+  };
+
+  /**
+   * One thread's blocks. Outlives the thread until every block it handed
+   * out has come back, so late frees from other threads stay valid.
+   */
+  struct free_lists {
+    std::array<header *, classes> heads{};
+    std::array<std::atomic<header *>, classes> remote{}; // Freed elsewhere
+    std::atomic<std::size_t> refs{1}; // The thread, plus each block in use
+
+    header *pop(std::size_t cls) {
+      header *&head = heads[cls];
+      if (!head)
+        head = remote[cls].exchange(nullptr, std::memory_order_acquire);
+      header *block = head;
+      if (block)
+        head = block->next;
+      return block;
+    }
+
+    void push(std::size_t cls, header *block) {
+      block->next = heads[cls];
+      heads[cls] = block;
+    }
+
+    // Any thread; only the owner takes the list, and it takes all of it
+    void push_remote(std::size_t cls, header *block) {
+      header *head = remote[cls].load(std::memory_order_relaxed);
+      do {
+        block->next = head;
+      } while (!remote[cls].compare_exchange_weak(
+          head, block, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void release() noexcept {
+      if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+
+    ~free_lists() {
+      for (std::size_t cls = 0; cls < classes; cls++) {
+        free_all(heads[cls]);
+        free_all(remote[cls].load(std::memory_order_acquire));
+      }
+    }
+
+    static void free_all(header *head) {
+      while (head) {
+        header *next = head->next;
+        ::operator delete(head);
+        head = next;
+      }
+    }
+  };
+
+  struct thread_owner {
+    free_lists *lists = new free_lists;
+    thread_owner() { current = lists; }
+    ~thread_owner() {
+      current = nullptr;
+      lists->release();
+    }
+  };
+
+  static std::size_t size_class(std::size_t size) {
+    return (size + sizeof(header) - 1) / granule;
+  }
+
+  static free_lists *local() {
+    thread_local thread_owner owner;
+    return owner.lists;
+  }
+
+  // This thread's lists, or nullptr if it has never allocated a frame
+  static inline thread_local free_lists *current = nullptr;
+};
+
+/**
+ * Promise mixin routing coroutine frame allocation through frame_allocator.
+ */
+struct recycled_frame {
+  static void *operator new(std::size_t size) {
+    return frame_allocator::allocate(size);
+  }
+
+  static void operator delete(void *ptr, std::size_t size) noexcept {
+    frame_allocator::deallocate(ptr, size);
+  }
+};
+
+/**
+ * Fire-and-forget coroutine with a recycled frame, e.g. one per stream.
+ */
+struct detached_task {
+  struct promise_type : recycled_frame {
+    detached_task get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+template <executor Executor = inline_executor> class async_denoiser {
+public:
+  class awaiter {
+  public:
+    awaiter(const awaiter &) = delete;
+    awaiter &operator=(const awaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept {
+      handle_ = handle;
+      job_.user_data = this;
+      if (audx_pool_submit(pool_, &job_) != 0) {
+        job_.vad_prob = -1.0f;
+        return false; // Resume immediately with the error
+      }
+      return true;
+    }
+
+    /**
+     * @return The probability of speech, or -1 on error.
+     */
+    float await_resume() const noexcept { return job_.vad_prob; }
+
+  private:
+    friend class async_denoiser;
+
+    awaiter(AudxPool *pool, Executor *executor, AudxState *state,
+            AudxJobFormat format, const void *in, void *out) noexcept
+        : pool_(pool), executor_(executor) {
+      job_.next = nullptr;
+      job_.state = state;
+      job_.format = format;
+      job_.in = in;
+      job_.out = out;
+      job_.vad_prob = -1.0f;
+      job_.done = &awaiter::on_done;
+      job_.user_data = nullptr;
+      job_.submit_ns = 0;
+    }
+
+    static void on_done(AudxJob *job) {
+      auto *self = static_cast<awaiter *>(job->user_data);
+      // Once posted, the coroutine may resume and free this awaiter (and the
+      // executor stored next to it) before post() returns, so post from
+      // copies.
+      Executor executor = *self->executor_;
+      executor.post(self->handle_);
+    }
+
+    AudxJob job_;
+    AudxPool *pool_;
+    Executor *executor_;
+    std::coroutine_handle<> handle_;
+  };
+
+  /**
+   * @param pool      Pool running the frames; must outlive the denoiser.
+   * @param state     Stream state; one frame of it is in flight at a time.
+   * @param executor  Where coroutines are resumed after a frame completes.
+   */
+  async_denoiser(AudxPool *pool, AudxState *state,
+                 Executor executor = Executor{})
+      : pool_(pool), state_(state), executor_(std::move(executor)) {}
+
+  /**
+   * Denoise one 10ms frame. Both spans must hold the state's frame size and
+   * stay valid until the await completes.
+   */
+  awaiter process(std::span<const short> in, std::span<short> out) {
+    return awaiter(pool_, &executor_, state_, AUDX_JOB_S16, in.data(),
+                   out.data());
+  }
+
+  awaiter process(std::span<const float> in, std::span<float> out) {
+    return awaiter(pool_, &executor_, state_, AUDX_JOB_F32, in.data(),
+                   out.data());
+  }
+
+  AudxState *state() const { return state_; }
+
+private:
+  AudxPool *pool_;
+  AudxState *state_;
+  Executor executor_;
+};
+
+} // namespace audx
+
+#endif // AUDX_ASYNC_HPP
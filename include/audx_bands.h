@@ -0,0 +1,60 @@
+#ifndef AUDX_BANDS_H
+#define AUDX_BANDS_H
+
+#include "kiss_fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Vectorized band kernels for RNNoise's denoise.c: analysis/synthesis
+ * windowing, band energy and correlation, band-to-bin gain interpolation and
+ * the pitch filter.
+ *
+ * Built into the rnnoise target in place of the originals unless
+ * AUDX_RNNOISE_BANDS is turned off. The originals stay in the target under
+ * _generic names.
+ */
+
+/**
+ * The kernels next to the RNNoise originals they replace, for checks and
+ * benchmarks.
+ */
+typedef struct AudxBandKernels {
+  int bands;  // Bands per feature vector
+  int bins;   // Bins per spectrum, up to and including Nyquist
+  int window; // Samples per analysis window
+
+  void (*apply_window)(float *x);
+  void (*apply_window_generic)(float *x);
+
+  void (*band_energy)(float *bandE, const kiss_fft_cpx *X);
+  void (*band_energy_generic)(float *bandE, const kiss_fft_cpx *X);
+
+  void (*band_corr)(float *bandE, const kiss_fft_cpx *X,
+                    const kiss_fft_cpx *P);
+  void (*band_corr_generic)(float *bandE, const kiss_fft_cpx *X,
+                            const kiss_fft_cpx *P);
+
+  void (*interp_band_gain)(float *g, const float *bandE);
+  void (*interp_band_gain_generic)(float *g, const float *bandE);
+
+  void (*pitch_filter)(kiss_fft_cpx *X, const kiss_fft_cpx *P,
+                       const float *Ex, const float *Ep, const float *Exp,
+                       const float *g);
+  void (*pitch_filter_generic)(kiss_fft_cpx *X, const kiss_fft_cpx *P,
+                               const float *Ex, const float *Ep,
+                               const float *Exp, const float *g);
+} AudxBandKernels;
+
+/**
+ * Get the band kernels.
+ */
+const AudxBandKernels *audx_band_kernels(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_BANDS_H
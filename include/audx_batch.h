@@ -0,0 +1,67 @@
+#ifndef AUDX_BATCH_H
+#define AUDX_BATCH_H
+
+#include "audx.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Whole-buffer denoising for batch workers.
+ *
+ * Each call frames the buffer, pads the tail and removes the pipeline delay,
+ * so the output is sample-aligned with the input. States are cached per
+ * thread and per (model, rate), and reset rather than recreated between
+ * calls, so after the first call on a thread setup costs almost nothing.
+ */
+
+// Cached states per thread; the least recently used one is evicted
+#define AUDX_BATCH_CACHE_SIZE 4
+
+// Largest 10ms frame, in samples, the scratch buffers are sized for (192kHz)
+#define AUDX_BATCH_MAX_FRAME 1920
+
+/**
+ * Number of VAD values audx_denoise_buffer() writes for n input samples: one
+ * per 10ms input frame, the last one possibly partial.
+ */
+static inline size_t audx_denoise_buffer_frames(size_t n, unsigned int rate) {
+  size_t frame = calculate_frame_sample(rate);
+  return frame ? (n + frame - 1) / frame : 0;
+}
+
+/**
+ * Denoise a whole buffer.
+ *
+ * @param model_path    Model file, NULL for the built-in model.
+ * @param in            n samples in `format`.
+ * @param n             Sample count.
+ * @param rate          Sample rate in Hz, at least 100 and with a 10ms frame
+ *                      of at most AUDX_BATCH_MAX_FRAME samples.
+ * @param format        Sample format of in and out.
+ * @param out           Receives n samples in `format`; may alias in.
+ * @param vad_track     Receives audx_denoise_buffer_frames(n, rate) speech
+ *                      probabilities, one per input frame; may be NULL.
+ *                      Each is the VAD of the processed frames that produced
+ *                      that frame's output, weighted by sample count, so the
+ *                      track is delay-compensated like the audio.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_denoise_buffer(const char *model_path, const void *in, size_t n,
+                        unsigned int rate, AudxBufferFormat format, void *out,
+                        float *vad_track);
+
+/**
+ * Destroy the calling thread's cached states. Happens automatically when the
+ * thread exits.
+ */
+void audx_denoise_buffer_release(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_BATCH_H
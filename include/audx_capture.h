@@ -0,0 +1,112 @@
+#ifndef AUDX_CAPTURE_H
+#define AUDX_CAPTURE_H
+
+#include "audx.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Traffic capture for offline reproduction.
+ *
+ * Attached AudxStates copy each input frame into a per-stream lock-free ring;
+ * a background thread drains all rings to one file. The file starts with
+ * AudxCaptureFileHeader followed by AudxCaptureRecord headers, each directly
+ * followed by `samples` samples in `format`. Records of one stream appear in
+ * order; records of different streams may interleave.
+ */
+
+#define AUDX_CAPTURE_MAGIC "AUDXCAP1"
+#define AUDX_CAPTURE_VERSION 1u
+
+typedef enum AudxCaptureFormat {
+  AUDX_CAPTURE_S16 = 0,
+  AUDX_CAPTURE_F32 = 1,
+} AudxCaptureFormat;
+
+typedef struct AudxCaptureFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size; // sizeof(AudxCaptureRecord)
+} AudxCaptureFileHeader;
+
+typedef struct AudxCaptureRecord {
+  uint64_t timestamp_ns; // CLOCK_MONOTONIC at capture
+  uint32_t stream_id;
+  uint32_t sample_rate;
+  uint32_t format; // AudxCaptureFormat
+  uint32_t samples;
+} AudxCaptureRecord;
+
+typedef struct AudxCapture AudxCapture;
+
+/**
+ * Open a capture file and start the drain thread.
+ *
+ * @param path          Output file.
+ * @param ring_bytes    Ring size per attached stream, rounded up to a power
+ *                      of two. Frames that do not fit are dropped and
+ *                      counted.
+ *
+ * @return The capture, or NULL on error.
+ */
+AudxCapture *audx_capture_open(const char *path, size_t ring_bytes);
+
+/**
+ * Start recording input frames of a state into a capture.
+ *
+ * @return 0 on success, -1 on error or if the state is already attached.
+ */
+int audx_capture_attach(AudxState *state, AudxCapture *capture,
+                        uint32_t stream_id);
+
+/**
+ * Stop recording a state. Frames already queued are still written.
+ * Called automatically by audx_destroy().
+ */
+void audx_capture_detach(AudxState *state);
+
+/**
+ * Number of frames dropped because a ring was full.
+ */
+uint64_t audx_capture_dropped(const AudxCapture *capture);
+
+/**
+ * Drain everything, stop the drain thread and close the file.
+ *
+ * All attached states must be detached or destroyed first.
+ */
+void audx_capture_close(AudxCapture *capture);
+
+// -----------------------------------------------------------------------------
+// INTERNAL (used by the processing path)
+// -----------------------------------------------------------------------------
+#ifdef AUDX_CAPTURE_INTERNAL
+
+typedef struct AudxCaptureRing AudxCaptureRing;
+
+AudxCaptureRing *audx_capture_ring_create(AudxCapture *capture,
+                                          uint32_t stream_id,
+                                          uint32_t sample_rate);
+
+/**
+ * Queue one frame. Called only from the thread processing the stream.
+ */
+void audx_capture_write(AudxCaptureRing *ring, const void *samples,
+                        uint32_t count, AudxCaptureFormat format);
+
+/**
+ * Hand the ring back to the drain thread, which frees it once empty.
+ */
+void audx_capture_ring_release(AudxCaptureRing *ring);
+
+#endif // AUDX_CAPTURE_INTERNAL
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_CAPTURE_H
@@ -14,6 +14,10 @@ typedef struct AudxDenoiseState AudxDenoiseState;
  *
  * @return The denoiser state.
  *
+ * A model file is loaded once and shared read-only by all denoisers created
+ * from the same path; it is freed with the last of them. The FFT, window and
+ * band tables are static data in RNNoise and shared likewise.
+ *
  * The denoiser must be destroyed with audx_denoise_destroy().
  */
 AudxDenoiseState *audx_denoise_create(char *model_path);
@@ -29,6 +33,44 @@ AudxDenoiseState *audx_denoise_create(char *model_path);
  */
 float audx_denoise_process(AudxDenoiseState *state, float *in, float *out);
 
+/**
+ * Native sample rate of the denoiser.
+ *
+ * AudxState resamples to this rate when the input rate differs, and skips
+ * resampling entirely when it matches.
+ *
+ * @param state The denoiser state.
+ *
+ * @return Sample rate in Hz.
+ */
+unsigned int audx_denoise_sample_rate(const AudxDenoiseState *state);
+
+/**
+ * Number of samples per 10ms frame at the denoiser's native rate.
+ *
+ * @param state The denoiser state.
+ */
+unsigned int audx_denoise_frame_size(const AudxDenoiseState *state);
+
+/**
+ * Delay from input to output at the denoiser's native rate: one frame.
+ */
+unsigned int audx_denoise_latency(const AudxDenoiseState *state);
+
+/**
+ * Return the denoiser to its freshly created state, keeping the model.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_denoise_reset(AudxDenoiseState *state);
+
+/**
+ * mlock the denoiser's own state. A model loaded from a file is not covered.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_denoise_lock_memory(AudxDenoiseState *state);
+
 /**
  * Free a denoiser.
  *
@@ -36,4 +78,68 @@ float audx_denoise_process(AudxDenoiseState *state, float *in, float *out);
  */
 void audx_denoise_destroy(AudxDenoiseState *state);
 
+/* --- Model tiers --- */
+
+#define AUDX_MAX_MODEL_TIERS 8
+
+/**
+ * A model tier. Tiers are ordered from best quality to cheapest; tier 0 is
+ * always the built-in model.
+ */
+typedef struct AudxModelTier {
+  const char *name;       // Human readable name, e.g. "3x256"
+  const char *model_path; // NULL for the built-in model
+} AudxModelTier;
+
+/**
+ * Register an additional model tier.
+ *
+ * Tiers must be registered in decreasing order of quality. The model file is
+ * loaded once to validate it.
+ *
+ * @param name          Tier name (copied).
+ * @param model_path    Path to the model file (copied).
+ *
+ * @return The tier index, or -1 if the model cannot be loaded or the tier
+ *         table is full.
+ */
+int audx_model_tier_register(const char *name, const char *model_path);
+
+/**
+ * Number of registered tiers, including the built-in one.
+ */
+int audx_model_tier_count(void);
+
+/**
+ * Get a tier description.
+ *
+ * @return The tier, or NULL if index is out of range.
+ */
+const AudxModelTier *audx_model_tier_get(int index);
+
+/**
+ * Measured processing cost of a tier on this machine.
+ *
+ * The first call runs the tier on synthetic input and caches the result.
+ *
+ * @return Microseconds per 10ms frame, or a negative value on error.
+ */
+float audx_model_tier_cost_us(int index);
+
+/**
+ * Select the best tier whose measured cost fits a per-stream budget.
+ *
+ * @param budget_us     Per-frame CPU budget in microseconds.
+ *
+ * @return The tier index, or -1 if no tier fits.
+ */
+int audx_model_tier_select(float budget_us);
+
+/**
+ * Create a denoiser using a registered tier.
+ *
+ * @return The denoiser state, or NULL on error.
+ */
+AudxDenoiseState *audx_denoise_create_tier(int index);
+
 #endif // AUDX_DENOISE_H
@@ -0,0 +1,40 @@
+#ifndef AUDX_ECHO_H
+#define AUDX_ECHO_H
+
+/**
+ * Opaque state of the echo canceller, a SpeexDSP MDF adaptive filter that
+ * works on the denoiser's frames.
+ */
+typedef struct AudxEchoState AudxEchoState;
+
+/**
+ * Create an echo canceller.
+ *
+ * @param sample_rate   Rate of the near- and far-end frames.
+ * @param frame_size    Samples per frame.
+ * @param tail_ms       Longest echo path to cancel.
+ *
+ * @return The echo canceller, or NULL on error.
+ */
+AudxEchoState *audx_echo_create(unsigned int sample_rate,
+                                unsigned int frame_size, unsigned int tail_ms);
+
+/**
+ * Remove the echo of the far-end reference from a near-end frame.
+ *
+ * @param near  frame_size samples in int16 units.
+ * @param far   The frame_size samples played out while near was captured,
+ *              or NULL for silence.
+ * @param out   Receives the cleaned frame; may alias near.
+ */
+void audx_echo_process(AudxEchoState *echo, const float *near,
+                       const short *far, float *out);
+
+/**
+ * Forget the adapted echo path.
+ */
+void audx_echo_reset(AudxEchoState *echo);
+
+void audx_echo_destroy(AudxEchoState *echo);
+
+#endif // AUDX_ECHO_H
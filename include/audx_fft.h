@@ -0,0 +1,45 @@
+#ifndef AUDX_FFT_H
+#define AUDX_FFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Real FFT specialized for RNNoise's 960-sample analysis window.
+ *
+ * The transform is computed as a 480-point complex FFT of the even/odd
+ * sample pairs plus a split pass. The complex FFT is a Stockham autosort
+ * with a fixed 4x4x2x3x5 plan on split real/imaginary arrays, so it needs no
+ * bit reversal. Twiddles are computed once per process.
+ *
+ * Built into the rnnoise target, where it replaces the generic kiss_fft for
+ * this size unless AUDX_RNNOISE_FFT is turned off.
+ */
+
+#define AUDX_FFT_SIZE 960
+#define AUDX_FFT_BINS (AUDX_FFT_SIZE / 2 + 1)
+
+/**
+ * Forward transform, X[k] = sum x[n] e^(-2 pi i k n / N), unscaled.
+ *
+ * @param in    AUDX_FFT_SIZE real samples.
+ * @param re    Receives AUDX_FFT_BINS real parts.
+ * @param im    Receives AUDX_FFT_BINS imaginary parts.
+ */
+void audx_fft_forward(const float *in, float *re, float *im);
+
+/**
+ * Inverse transform of a Hermitian spectrum given by its first
+ * AUDX_FFT_BINS bins, x[n] = sum X[k] e^(2 pi i k n / N), unscaled. The
+ * imaginary parts of the DC and Nyquist bins are ignored.
+ *
+ * @param out   Receives AUDX_FFT_SIZE real samples.
+ */
+void audx_fft_inverse(const float *re, const float *im, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_FFT_H
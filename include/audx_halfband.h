@@ -0,0 +1,53 @@
+#ifndef AUDX_HALFBAND_H
+#define AUDX_HALFBAND_H
+
+#include <stdbool.h>
+
+/**
+ * Linear-phase half-band FIR stage for 2:1 decimation or 1:2 interpolation.
+ *
+ * Every other tap of a half-band filter is zero and the centre tap is 0.5,
+ * so a stage costs about a quarter of a general FIR of the same length. The
+ * filter is split into polyphase branches and the symmetric taps are folded,
+ * leaving one multiply-add per tap pair per output, vectorized across
+ * outputs.
+ */
+typedef struct AudxHalfband AudxHalfband;
+
+/**
+ * Create a stage.
+ *
+ * @param decimate      true for 2:1 decimation, false for 1:2 interpolation.
+ * @param transition    Transition band width relative to the high rate
+ *                      (0 < transition < 0.5). The filter is sized for 86 dB
+ *                      stopband attenuation over it.
+ *
+ * @return The stage, or NULL on error.
+ */
+AudxHalfband *audx_halfband_create(bool decimate, double transition);
+
+/**
+ * Filter a block of any length.
+ *
+ * A decimator writes one sample per even-indexed input sample (counting
+ * across calls), at most (count + 1) / 2; an interpolator writes exactly
+ * 2 * count samples.
+ *
+ * @return The number of samples written.
+ */
+unsigned int audx_halfband_process(AudxHalfband *hb, const float *in,
+                                   unsigned int count, float *out);
+
+/**
+ * Delay of the stage in samples at the high rate.
+ */
+unsigned int audx_halfband_delay(const AudxHalfband *hb);
+
+/**
+ * Clear the filter history.
+ */
+void audx_halfband_reset(AudxHalfband *hb);
+
+void audx_halfband_destroy(AudxHalfband *hb);
+
+#endif // AUDX_HALFBAND_H
@@ -0,0 +1,72 @@
+#ifndef AUDX_POOL_H
+#define AUDX_POOL_H
+
+#include "audx.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Worker pool for asynchronous processing.
+ *
+ * Callers embed an AudxJob in their own storage and submit it; the pool links
+ * jobs through the intrusive `next` field, so submitting never allocates.
+ * Workers take queued jobs in batches, process each with audx_process() or
+ * audx_process_int(), and invoke `done` on the worker thread.
+ *
+ * A state is not thread-safe: keep at most one job per state in flight.
+ */
+
+typedef enum AudxJobFormat {
+  AUDX_JOB_F32 = 0,
+  AUDX_JOB_S16 = 1,
+} AudxJobFormat;
+
+typedef struct AudxJob AudxJob;
+
+struct AudxJob {
+  AudxJob *next; // Owned by the pool while queued
+  AudxState *state;
+  AudxJobFormat format;
+  const void *in;
+  void *out;
+  float vad_prob; // Result, -1 on error
+  void (*done)(AudxJob *job);
+  void *user_data;
+  uint64_t submit_ns; // Set by the pool while tracing
+};
+
+typedef struct AudxPool AudxPool;
+
+// Upper bound on jobs a worker takes per queue lock acquisition
+#define AUDX_POOL_MAX_BATCH 16
+
+/**
+ * Start a pool.
+ *
+ * @param threads   Worker count, 0 for one per online CPU.
+ *
+ * @return The pool, or NULL on error.
+ */
+AudxPool *audx_pool_create(unsigned int threads);
+
+/**
+ * Queue a job. The job must stay valid until its done callback runs, which
+ * may happen before this call returns.
+ *
+ * @return 0 on success, -1 on invalid arguments or a stopping pool.
+ */
+int audx_pool_submit(AudxPool *pool, AudxJob *job);
+
+/**
+ * Run all queued jobs, then stop the workers and free the pool.
+ */
+void audx_pool_destroy(AudxPool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_POOL_H
@@ -15,6 +15,28 @@ int audx_resampler_process(AudxResamplerState *st, const float *in,
                            unsigned int *in_len, float *out,
                            unsigned int *out_len);
 
+/**
+ * Change the conversion ratio without resetting the filter history.
+ *
+ * The ratio is ratio_num/ratio_den (input/output); in_rate and out_rate are
+ * the nominal rates used to size the anti-aliasing filter.
+ */
+int audx_resampler_set_rate_frac(AudxResamplerState *st,
+                                 unsigned int ratio_num,
+                                 unsigned int ratio_den, unsigned int in_rate,
+                                 unsigned int out_rate);
+
+/**
+ * Clear the filter history, as if no samples had been processed.
+ */
+int audx_resampler_reset(AudxResamplerState *st);
+
+/**
+ * Group delay of the converter, in samples at the output rate. Not exact to
+ * the sample for fractional ratios.
+ */
+double audx_resampler_delay(const AudxResamplerState *st);
+
 void audx_resampler_destroy(AudxResamplerState *st);
 
 #endif // AUDX_RESAMPLER_H
@@ -0,0 +1,105 @@
+#ifndef AUDX_RT_H
+#define AUDX_RT_H
+
+#include "audx.h"
+#include "audx_pool.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Real-time preparation of processing threads and the memory they touch.
+ *
+ * Every step is attempted even if an earlier one fails; the return value is
+ * a bitmask of AUDX_RT_FAILED_* flags for the steps that failed, typically
+ * with EPERM for lack of CAP_SYS_NICE / CAP_IPC_LOCK or RLIMIT_RTPRIO /
+ * RLIMIT_MEMLOCK. 0 means everything requested succeeded.
+ */
+
+#define AUDX_RT_FAILED_AFFINITY (1 << 0)
+#define AUDX_RT_FAILED_SCHED (1 << 1)
+#define AUDX_RT_FAILED_MLOCK (1 << 2)
+#define AUDX_RT_FAILED_MLOCKALL (1 << 3)
+#define AUDX_RT_FAILED_PREFAULT (1 << 4)
+
+typedef enum AudxRtPolicy {
+  AUDX_RT_POLICY_NONE = 0, // Leave the scheduling policy unchanged
+  AUDX_RT_POLICY_FIFO = 1,
+  AUDX_RT_POLICY_RR = 2,
+} AudxRtPolicy;
+
+typedef struct AudxRtOptions {
+  int cpu;               // CPU to pin to, -1 to leave affinity unchanged.
+                         // Pool workers get consecutive CPUs from here.
+  AudxRtPolicy policy;   // Real-time scheduling class
+  int priority;          // Priority within the class (1-99 on Linux)
+  bool lock_memory;      // mlock state memory, library code and tables
+  bool lock_all;         // mlockall(MCL_CURRENT | MCL_FUTURE)
+  size_t prefault_stack; // Bytes of the calling thread's stack to touch
+} AudxRtOptions;
+
+/**
+ * Fill in defaults: no pinning, SCHED_FIFO priority 10, targeted mlock, no
+ * mlockall, 256 KiB of stack prefaulted.
+ */
+void audx_rt_default_options(AudxRtOptions *opts);
+
+/**
+ * Prepare the calling thread: affinity, scheduling, stack prefault and,
+ * when requested, locking of the library's code and tables and mlockall.
+ *
+ * @return Bitmask of failed steps, 0 on success.
+ */
+int audx_rt_prepare_thread(const AudxRtOptions *opts);
+
+/**
+ * Prepare the calling thread to run a state, and lock the state's own
+ * memory: its arena blocks and the denoiser state. Resampler internals and
+ * models loaded from files are only covered by lock_all.
+ *
+ * @return Bitmask of failed steps, 0 on success.
+ */
+int audx_rt_prepare_state(AudxState *state, const AudxRtOptions *opts);
+
+/**
+ * Apply affinity and scheduling to every worker of a pool, lock the
+ * library's memory as for a thread, and prefault each worker's stack from
+ * a call run on it. Waits for workers busy with queued jobs.
+ *
+ * @return Bitmask of failed steps, 0 on success.
+ */
+int audx_rt_prepare_pool(AudxPool *pool, const AudxRtOptions *opts);
+
+// -----------------------------------------------------------------------------
+// INTERNAL (implemented next to the structures they lock)
+// -----------------------------------------------------------------------------
+#ifdef AUDX_RT_INTERNAL
+#include <pthread.h>
+
+/**
+ * mlock the arena blocks and denoiser of a state. Returns 0 or -1.
+ */
+int audx_state_lock_memory(AudxState *state);
+
+unsigned int audx_pool_thread_count(const AudxPool *pool);
+
+pthread_t audx_pool_thread(const AudxPool *pool, unsigned int index);
+
+/**
+ * Run fn(arg) once on every worker of a pool, after the jobs already queued,
+ * and wait for all calls to return. Returns 0, or -1 if a call failed or the
+ * pool is stopping.
+ */
+int audx_pool_run_on_workers(AudxPool *pool, int (*fn)(void *arg),
+                             void *arg);
+
+#endif // AUDX_RT_INTERNAL
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_RT_H
@@ -0,0 +1,104 @@
+#ifndef AUDX_SEGMENT_H
+#define AUDX_SEGMENT_H
+
+#include "audx.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * VAD-driven speech segmentation.
+ *
+ * Feed each denoised frame together with the speech probability
+ * audx_process() returned for it. A segment opens when the probability
+ * reaches start_threshold and closes once it has stayed below
+ * stop_threshold for longer than the hangover, or when it reaches the
+ * maximum length. On open, up to preroll_ms of the audio before the
+ * triggering frame is included.
+ *
+ * Audio is kept in an internal ring. Each push returns the speech it
+ * released as references into that ring, so only speech needs to be copied
+ * or sent downstream. Timestamps count samples pushed since creation or the
+ * last reset; subtract audx_latency() to map them onto the input timeline.
+ */
+
+// Defaults for zero config fields
+#define AUDX_SEGMENT_START_THRESHOLD 0.6f
+#define AUDX_SEGMENT_STOP_THRESHOLD 0.4f
+#define AUDX_SEGMENT_HANGOVER_MS 300
+#define AUDX_SEGMENT_PREROLL_MS 200
+#define AUDX_SEGMENT_MAX_MS 15000
+
+enum {
+  AUDX_SEGMENT_STARTED = 1 << 0,
+  AUDX_SEGMENT_ENDED = 1 << 1,
+};
+
+typedef struct AudxSegmenterConfig {
+  unsigned int sample_rate;
+  AudxBufferFormat format; // Format of pushed frames and returned audio
+  float start_threshold;   // Probability that opens a segment
+  float stop_threshold;    // Frames below this count towards the hangover
+  unsigned int hangover_ms;
+  unsigned int preroll_ms;
+  unsigned int max_segment_ms;
+} AudxSegmenterConfig;
+
+/**
+ * Result of one push. A frame can end one segment and start the next, in
+ * which case the audio belongs to the new segment.
+ */
+typedef struct AudxSegmentOutput {
+  unsigned int events; // AUDX_SEGMENT_STARTED and/or AUDX_SEGMENT_ENDED
+  uint64_t start;      // With STARTED: first sample of the new segment
+  uint64_t end;        // With ENDED: one past the last sample of the segment
+  // Speech released by this push, in order. The second part is used only
+  // when the audio wraps around the ring. Valid until the next push, flush
+  // or reset.
+  const void *data[2];
+  unsigned int len[2];
+  uint64_t data_start; // Sample index of the first sample of data[0]
+} AudxSegmentOutput;
+
+typedef struct AudxSegmenter AudxSegmenter;
+
+/**
+ * Create a segmenter. Zero thresholds and durations take the defaults
+ * above; the start threshold must not be below the stop threshold.
+ *
+ * @return The segmenter, or NULL on invalid configuration or allocation
+ *         failure.
+ */
+AudxSegmenter *audx_segmenter_create(const AudxSegmenterConfig *config);
+
+/**
+ * Push one 10ms frame, calculate_frame_sample(sample_rate) samples in the
+ * configured format, and its speech probability.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_segmenter_push(AudxSegmenter *seg, const void *frame, float vad_prob,
+                        AudxSegmentOutput *out);
+
+/**
+ * End the open segment, if any, at the last pushed sample. Call at the end
+ * of a stream.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_segmenter_flush(AudxSegmenter *seg, AudxSegmentOutput *out);
+
+/**
+ * Drop any open segment and restart timestamps at 0.
+ */
+void audx_segmenter_reset(AudxSegmenter *seg);
+
+void audx_segmenter_destroy(AudxSegmenter *seg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_SEGMENT_H
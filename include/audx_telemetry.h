@@ -0,0 +1,114 @@
+#ifndef AUDX_TELEMETRY_H
+#define AUDX_TELEMETRY_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * Shared-memory telemetry.
+ *
+ * When enabled, the library publishes per-stream counters into a POSIX
+ * shared-memory segment. Each stream slot is written only by the thread
+ * processing that stream and is protected by a seqlock, so external readers
+ * (see tools/audx_top.c) never block the audio threads.
+ *
+ * Segment layout: AudxTelemetryHeader followed by max_streams
+ * AudxTelemetryStream slots. The layout is versioned; readers must check
+ * magic, version and the struct sizes recorded in the header.
+ */
+
+#define AUDX_TELEMETRY_MAGIC 0x58445541u // "AUDX"
+#define AUDX_TELEMETRY_VERSION 1u
+
+// Latency histogram: bucket 0 is < 1us, bucket b is [2^(b-1), 2^b) us and the
+// last bucket collects everything slower.
+#define AUDX_TELEMETRY_HIST_BUCKETS 16
+
+// Stages with their own latency histogram (same order as AudxTraceStage).
+#define AUDX_TELEMETRY_STAGES 6
+
+typedef struct AudxTelemetryHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size;
+  uint32_t stream_size;
+  uint32_t max_streams;
+  uint32_t pid;
+  uint32_t deadline_us;
+  uint32_t reserved;
+  atomic_uint_fast64_t streams_created;
+  atomic_uint_fast64_t streams_destroyed;
+  atomic_uint_fast64_t streams_untracked; // created while all slots were used
+} AudxTelemetryHeader;
+
+typedef struct AudxTelemetryStream {
+  atomic_uint seq;    // Seqlock: odd while the slot is being written
+  atomic_uint in_use; // 1 while a live AudxState owns the slot
+  uint64_t stream_id; // Unique per process, slots are reused
+  uint32_t in_rate;
+  uint32_t reserved;
+  uint64_t frames;
+  uint64_t skipped;         // Frames that failed to process
+  uint64_t deadline_misses; // Frames slower than deadline_us
+  double vad_sum;           // Sum of per-frame speech probability
+  uint64_t stage_hist[AUDX_TELEMETRY_STAGES][AUDX_TELEMETRY_HIST_BUCKETS];
+} __attribute__((aligned(64))) AudxTelemetryStream;
+
+/**
+ * Create the telemetry segment and start publishing.
+ *
+ * Only AudxStates created after this call are tracked.
+ *
+ * @param name          Shared-memory name (e.g. "/audx"). If NULL,
+ *                      "/audx-<pid>" is used.
+ * @param max_streams   Number of stream slots.
+ * @param deadline_us   Per-frame deadline used for miss counting; 0 uses the
+ *                      10ms frame duration.
+ *
+ * @return 0 on success, -1 on error or when shared memory is unavailable.
+ */
+int audx_telemetry_open(const char *name, unsigned int max_streams,
+                        unsigned int deadline_us);
+
+/**
+ * Stop publishing and unlink the segment.
+ *
+ * Must not be called while AudxStates created after audx_telemetry_open()
+ * are still alive.
+ */
+void audx_telemetry_close(void);
+
+/**
+ * Return the slot at index from a mapped segment (reader side).
+ */
+static inline AudxTelemetryStream *
+audx_telemetry_stream_at(AudxTelemetryHeader *header, unsigned int index) {
+  return (AudxTelemetryStream *)((uint8_t *)header + header->header_size +
+                                 (uint64_t)index * header->stream_size);
+}
+
+// -----------------------------------------------------------------------------
+// INTERNAL (used by the processing path)
+// -----------------------------------------------------------------------------
+#ifdef AUDX_TELEMETRY_INTERNAL
+
+#include <stdbool.h>
+
+/**
+ * Claim a slot for a new stream. Returns NULL when telemetry is off or all
+ * slots are in use.
+ */
+AudxTelemetryStream *audx_telemetry_attach(unsigned int in_rate);
+
+void audx_telemetry_detach(AudxTelemetryStream *slot);
+
+/**
+ * Publish one frame. stage_ns holds the duration of each stage (0 = stage
+ * not run); the frame stage decides deadline misses.
+ */
+void audx_telemetry_publish(AudxTelemetryStream *slot, const uint64_t *stage_ns,
+                            float vad_prob, bool skipped);
+
+#endif // AUDX_TELEMETRY_INTERNAL
+
+#endif // AUDX_TELEMETRY_H
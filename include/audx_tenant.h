@@ -0,0 +1,104 @@
+#ifndef AUDX_TENANT_H
+#define AUDX_TENANT_H
+
+#include "audx.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Per-tenant CPU accounting and quotas.
+ *
+ * States created with a tenant ID charge the thread CPU time spent inside
+ * audx_process*() to that tenant. Charges go to per-CPU counters and are only
+ * summed when read, so streams of one tenant on different cores never share
+ * a cache line.
+ *
+ * With a quota set, usage is evaluated once per second. A tenant over quota
+ * is stepped down one mode per second until it fits. It is stepped back up
+ * once the cost last measured in the mode above was under 80% of the quota;
+ * that measurement is retried after 30 seconds, so a tenant that does not fit
+ * changes mode at most that often:
+ *
+ *   AUDX_TENANT_NORMAL   full processing
+ *   AUDX_TENANT_REDUCED  the cheapest registered model tier (see
+ *                        audx_denoise.h), resamplers at quality 0
+ *   AUDX_TENANT_BYPASS   audio passes through undenoised, VAD reports 0
+ *
+ * The reduced tier and the quality-0 resamplers are created with the state,
+ * so a mode change never allocates on the audio thread. Switching denoisers
+ * or resamplers restarts the incoming ones from a clean history.
+ *
+ * Bypassed audio is delayed by audx_latency() of the mode before it, so it
+ * lines up with the denoised audio around it. A stream leaving bypass
+ * restarts its pipeline from clean history.
+ */
+
+#define AUDX_MAX_TENANTS 256
+
+typedef enum AudxTenantMode {
+  AUDX_TENANT_NORMAL = 0,
+  AUDX_TENANT_REDUCED = 1,
+  AUDX_TENANT_BYPASS = 2,
+} AudxTenantMode;
+
+/**
+ * Like audx_create(), charging processing time to a tenant.
+ *
+ * @return The state, or NULL on error or when AUDX_MAX_TENANTS distinct
+ *         tenants already exist.
+ */
+AudxState *audx_create_with_tenant(char *model_path, unsigned int in_rate,
+                                   int resample_quality, uint32_t tenant_id);
+
+/**
+ * Set a quota as a share of one core (0.5 = half a core). 0 removes the quota
+ * and restores normal processing.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int audx_tenant_set_quota(uint32_t tenant_id, double cores);
+
+/**
+ * Total thread CPU time charged to a tenant, in nanoseconds.
+ */
+uint64_t audx_tenant_cpu_ns(uint32_t tenant_id);
+
+/**
+ * Current processing mode of a tenant's streams.
+ */
+AudxTenantMode audx_tenant_mode(uint32_t tenant_id);
+
+// -----------------------------------------------------------------------------
+// INTERNAL (used by the processing path)
+// -----------------------------------------------------------------------------
+#ifdef AUDX_TENANT_INTERNAL
+
+typedef struct AudxTenant AudxTenant;
+
+/**
+ * Find or create a tenant. Tenants live for the lifetime of the process.
+ */
+AudxTenant *audx_tenant_get(uint32_t tenant_id);
+
+/**
+ * Thread CPU clock, read at the start and end of a process call.
+ */
+uint64_t audx_tenant_clock_ns(void);
+
+/**
+ * Charge CPU time and, at most once per window, re-evaluate the quota.
+ */
+void audx_tenant_charge(AudxTenant *tenant, uint64_t cpu_ns);
+
+AudxTenantMode audx_tenant_current_mode(const AudxTenant *tenant);
+
+#endif // AUDX_TENANT_INTERNAL
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_TENANT_H
@@ -0,0 +1,77 @@
+#ifndef AUDX_TRACE_H
+#define AUDX_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Pipeline stages recorded by the tracer.
+ */
+typedef enum AudxTraceStage {
+  AUDX_TRACE_FRAME = 0,       // Whole audx_process* call
+  AUDX_TRACE_CONVERT_IN,      // int16 -> float conversion
+  AUDX_TRACE_UPSAMPLE,        // in_rate -> 48kHz resampling
+  AUDX_TRACE_DENOISE,         // rnnoise_process_frame
+  AUDX_TRACE_DOWNSAMPLE,      // 48kHz -> in_rate resampling
+  AUDX_TRACE_CONVERT_OUT,     // float -> int16 conversion
+  AUDX_TRACE_STAGE_COUNT,     // Pipeline stages, which telemetry also times
+  // Worker pool (audx_pool.h); the frame argument is 0 for waits and the
+  // batch size for batches
+  AUDX_TRACE_POOL_WAIT = AUDX_TRACE_STAGE_COUNT, // Submit to a worker taking it
+  AUDX_TRACE_POOL_BATCH,                         // One batch on a worker
+  AUDX_TRACE_EVENT_COUNT
+} AudxTraceStage;
+
+/**
+ * Start tracing and write events to a Chrome trace JSON file.
+ *
+ * Each thread that processes frames records begin/end timestamps into its own
+ * lock-free ring buffer. A background thread drains the buffers to `path`.
+ * The resulting file can be opened in chrome://tracing or ui.perfetto.dev.
+ *
+ * @param path  Output file path.
+ *
+ * @return 0 on success, -1 if tracing is already running or the file or
+ *         flusher thread could not be created.
+ */
+int audx_trace_start(const char *path);
+
+/**
+ * Stop tracing, flush all pending events and close the output file.
+ */
+void audx_trace_stop(void);
+
+/**
+ * Check whether tracing is currently active.
+ */
+bool audx_trace_enabled(void);
+
+/**
+ * Number of events dropped because a per-thread buffer was full.
+ */
+uint64_t audx_trace_dropped(void);
+
+// -----------------------------------------------------------------------------
+// INTERNAL (used by the processing path)
+// -----------------------------------------------------------------------------
+#ifdef AUDX_TRACE_INTERNAL
+
+#include <stdatomic.h>
+
+// Checked by the processing path before taking timestamps.
+extern atomic_bool audx_trace_active;
+
+void audx_trace_record(AudxTraceStage stage, uint64_t begin_ns,
+                       uint64_t end_ns, const void *stream, uint64_t frame);
+
+#endif // AUDX_TRACE_INTERNAL
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDX_TRACE_H
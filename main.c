@@ -2,19 +2,31 @@
 #include "audx_time.h"
 
 #include "audx.h"
+#include "audx_capture.h"
+#include "audx_trace.h"
+#include "tools/audx_pcap.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 int main(int argc, char **argv) {
+  if (argc > 1 && strcmp(argv[1], "--pcap") == 0)
+    return audx_pcap_main(argc - 2, argv + 2);
+
   if (argc < 4) {
     fprintf(stderr,
-            "Usage: %s <noisy speech> <output denoised> <sample rate>\n",
-            argv[0]);
+            "Usage: %s <noisy speech> <output denoised> <sample rate>\n"
+            "       %s --pcap <capture.pcap|pcapng> <output dir>\n",
+            argv[0], argv[0]);
     return 1;
   }
 
+  // Optional Chrome trace of per-frame stage timings
+  const char *trace_path = getenv("AUDX_TRACE");
+  if (trace_path && audx_trace_start(trace_path) != 0)
+    fprintf(stderr, "Failed to start tracing to %s\n", trace_path);
+
   uint64_t start = audx_now_ns();
 
   FILE *f1 = fopen(argv[1], "rb");
@@ -22,6 +34,15 @@ int main(int argc, char **argv) {
   unsigned int sample_rate = atoi(argv[3]);
 
   AudxState *state = audx_create(NULL, sample_rate, 4);
+
+  // Optional capture of input frames for audx_replay
+  AudxCapture *capture = NULL;
+  const char *capture_path = getenv("AUDX_CAPTURE");
+  if (capture_path) {
+    capture = audx_capture_open(capture_path, 1 << 20);
+    if (!capture || audx_capture_attach(state, capture, 0) != 0)
+      fprintf(stderr, "Failed to start capture to %s\n", capture_path);
+  }
   unsigned int in_len = calculate_frame_sample(sample_rate);
 
   bool first = true;
@@ -66,6 +87,8 @@ int main(int argc, char **argv) {
   printf("Time: %f ms\n", (end - start) / 1e9);
 
   audx_destroy(state);
+  audx_capture_close(capture);
+  audx_trace_stop();
   fclose(fout);
   fclose(f1);
 
@@ -2,119 +2,478 @@
 #include "audx.h"
 #include "arena.h"
 #include "audx_denoise.h"
+#include "audx_echo.h"
 #include "audx_resampler.h"
+#define AUDX_RT_INTERNAL
+#include "audx_rt.h"
+#define AUDX_CAPTURE_INTERNAL
+#include "audx_capture.h"
+#define AUDX_TELEMETRY_INTERNAL
+#include "audx_telemetry.h"
+#define AUDX_TENANT_INTERNAL
+#include "audx_tenant.h"
+#include "audx_time.h"
+#define AUDX_TRACE_INTERNAL
+#include "audx_trace.h"
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
-
-// SIMD intrinsics for different architectures
-#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||             \
-    defined(_M_IX86)
-#include <emmintrin.h> // SSE2
-#include <smmintrin.h> // SSE4.1 for _mm_cvtepi16_epi32
-#define HAS_X86_SIMD 1
-#elif defined(__ARM_NEON) || defined(__aarch64__)
-#include <arm_neon.h>
-#define HAS_ARM_NEON 1
-#endif
+#include <string.h>
+#include <sys/mman.h>
 
 struct AudxState {
   unsigned int in_rate;
   unsigned int in_len;
+  unsigned int proc_rate; // Denoiser native rate
+  unsigned int proc_len;  // Denoiser native frame size
   int resample_quality;
   bool need_resample;
   AudxResamplerState *upsampler;
   float *upsampler_buf;
   AudxResamplerState *downsampler;
   float *downsampler_buf;
-  AudxDenoiseState *denoiser;
+  AudxDenoiseState *denoiser;         // Active: full or reduced
+  AudxDenoiseState *full_denoiser;
+  AudxDenoiseState *reduced_denoiser; // Cheaper tier for REDUCED, or NULL
+  uint64_t frame_index;
+  AudxTelemetryStream *telemetry;
+  AudxCaptureRing *capture;
+  uint64_t stage_ns[AUDX_TRACE_STAGE_COUNT];
+  bool asrc_enabled;
+  unsigned int asrc_delay; // Added by the ASRC-only downsampler at native rate
+  double asrc_max_ppm;
+  double asrc_ppm;
+  double asrc_integral;
+  bool output_stage_enabled;
+  AudxOutputStage output_stage;
+  AudxTenant *tenant;
+  AudxTenantMode tenant_mode;
+  // Input delayed by the pipeline latency, played out while bypassed. The
+  // line holds the longest latency of any mode; bypass_len is the current one.
+  float *bypass_delay;
+  unsigned int bypass_len;
+  unsigned int bypass_cap;
+  unsigned int bypass_pos;
+  AudxEchoState *echo;                // NULL unless AEC is enabled
+  AudxResamplerState *echo_resampler; // Far end to the processing rate
+  // Resamplers at the other quality, swapped with the active ones when the
+  // tenant mode changes. NULL unless a tenant state resamples.
+  AudxResamplerState *spare_upsampler;
+  AudxResamplerState *spare_downsampler;
+  AudxResamplerState *spare_echo_resampler;
+  bool fast_resamplers; // The quality-0 set is active
+  short *echo_far;                    // Far-end frame at the processing rate
+  bool echo_far_set;                  // echo_far belongs to the current frame
   Arena *arena;
 };
 
-AudxState *audx_create(char *model_path, unsigned int in_rate,
-                       int resample_quality) {
+_Static_assert(AUDX_TELEMETRY_STAGES == AUDX_TRACE_STAGE_COUNT,
+               "telemetry histograms must cover every traced stage");
+
+// ASRC ratio fixed-point scale: 1 ppm resolution
+#define ASRC_RATIO_SCALE 1000000u
+// Frames over which the proportional term corrects a fill-level error
+#define ASRC_CORRECTION_FRAMES 100.0
+// Integral term time constant relative to the proportional one
+#define ASRC_INTEGRAL_RATIO 0.005
+
+/**
+ * Build a state around a denoiser, which the state takes over. The denoiser
+ * decides the processing rate; resampling is only needed when the input
+ * rate differs from it.
+ */
+static AudxState *create_state(AudxDenoiseState *denoiser,
+                               unsigned int in_rate, int resample_quality) {
+  if (!denoiser)
+    return NULL;
 
   Arena *arena = arena_init(16 * 1014);
   if (!arena) {
+    audx_denoise_destroy(denoiser);
     return NULL;
   }
 
   AudxState *state =
       arena_alloc(arena, sizeof(AudxState), ARENA_ALIGNOF(AudxState));
   if (!state) {
+    audx_denoise_destroy(denoiser);
+    arena_free(arena);
     return NULL;
   }
 
   state->resample_quality = resample_quality;
+  state->frame_index = 0;
+  state->upsampler = NULL;
+  state->upsampler_buf = NULL;
+  state->downsampler = NULL;
+  state->downsampler_buf = NULL;
+  state->capture = NULL;
+  state->asrc_enabled = false;
+  state->asrc_delay = 0;
+  state->asrc_max_ppm = 0.0;
+  state->asrc_ppm = 0.0;
+  state->asrc_integral = 0.0;
+  state->output_stage_enabled = false;
+  state->tenant = NULL;
+  state->tenant_mode = AUDX_TENANT_NORMAL;
+  state->reduced_denoiser = NULL;
+  state->bypass_delay = NULL;
+  state->bypass_len = 0;
+  state->bypass_cap = 0;
+  state->bypass_pos = 0;
+  state->echo = NULL;
+  state->echo_resampler = NULL;
+  state->spare_upsampler = NULL;
+  state->spare_downsampler = NULL;
+  state->spare_echo_resampler = NULL;
+  state->fast_resamplers = false;
+  state->echo_far = NULL;
+  state->echo_far_set = false;
+  memset(state->stage_ns, 0, sizeof(state->stage_ns));
   state->in_rate = in_rate;
   state->in_len = calculate_frame_sample(in_rate);
 
-  state->need_resample = in_rate != FRAME_RATE;
+  state->denoiser = denoiser;
+  state->full_denoiser = denoiser;
+  state->proc_rate = audx_denoise_sample_rate(state->denoiser);
+  state->proc_len = audx_denoise_frame_size(state->denoiser);
+
+  state->need_resample = in_rate != state->proc_rate;
   if (state->need_resample) {
-    state->upsampler =
-        audx_resampler_create(in_rate, FRAME_RATE, state->resample_quality);
+    state->upsampler = audx_resampler_create(in_rate, state->proc_rate,
+                                             state->resample_quality);
     if (!state->upsampler) {
+      audx_denoise_destroy(state->denoiser);
       arena_free(arena);
       return NULL;
     }
 
-    state->upsampler_buf =
-        arena_alloc(arena, sizeof(float) * FRAME_SIZE, ARENA_ALIGNOF(float));
+    state->upsampler_buf = arena_alloc(arena, sizeof(float) * state->proc_len,
+                                       ARENA_ALIGNOF(float));
     if (!state->upsampler_buf) {
       audx_resampler_destroy(state->upsampler);
+      audx_denoise_destroy(state->denoiser);
       arena_free(arena);
       return NULL;
     }
 
-    state->downsampler =
-        audx_resampler_create(FRAME_RATE, in_rate, state->resample_quality);
+    state->downsampler = audx_resampler_create(state->proc_rate, in_rate,
+                                               state->resample_quality);
     if (!state->downsampler) {
       audx_resampler_destroy(state->upsampler);
+      audx_denoise_destroy(state->denoiser);
       arena_free(arena);
       return NULL;
     }
 
-    state->downsampler_buf =
-        arena_alloc(arena, sizeof(float) * state->in_len, ARENA_ALIGNOF(float));
+    // Holds the denoiser output, so it is sized at the processing rate.
+    state->downsampler_buf = arena_alloc(arena, sizeof(float) * state->proc_len,
+                                         ARENA_ALIGNOF(float));
     if (!state->downsampler_buf) {
       audx_resampler_destroy(state->upsampler);
       audx_resampler_destroy(state->downsampler);
+      audx_denoise_destroy(state->denoiser);
       arena_free(arena);
       return NULL;
     }
   }
 
-  state->denoiser = audx_denoise_create(model_path);
-  if (!state->denoiser) {
-    if (state->need_resample) {
-      audx_resampler_destroy(state->upsampler);
-      audx_resampler_destroy(state->downsampler);
-    }
-    arena_free(arena);
+  state->telemetry = audx_telemetry_attach(in_rate);
+  state->arena = arena;
+  return state;
+}
+
+AudxState *audx_create(char *model_path, unsigned int in_rate,
+                       int resample_quality) {
+  return create_state(audx_denoise_create(model_path), in_rate,
+                      resample_quality);
+}
+
+/**
+ * Delay of audx_process() in input-rate samples with the given resamplers.
+ * At the native rate it runs neither, even when ASRC added a downsampler.
+ */
+static unsigned int pipeline_latency(const AudxState *state,
+                                     const AudxResamplerState *upsampler,
+                                     const AudxResamplerState *downsampler) {
+  double delay = (double)audx_denoise_latency(state->denoiser) *
+                 state->in_rate / state->proc_rate;
+  if (state->need_resample) {
+    delay += audx_resampler_delay(upsampler) * state->in_rate /
+             state->proc_rate;
+    delay += audx_resampler_delay(downsampler);
+  }
+  return (unsigned int)lround(delay);
+}
+
+/**
+ * Size the bypass delay line for the longest latency of either resampler
+ * set on either path and clear it. Called again whenever the pipeline gains
+ * a stage.
+ */
+static int bypass_delay_init(AudxState *state) {
+  unsigned int len = audx_latency(state);
+  unsigned int cap = len;
+  if (state->spare_upsampler) {
+    unsigned int spare = pipeline_latency(state, state->spare_upsampler,
+                                          state->spare_downsampler);
+    if (spare > cap)
+      cap = spare;
+  }
+  cap += state->asrc_delay;
+
+  if (cap > state->bypass_cap) {
+    float *delay =
+        arena_alloc(state->arena, sizeof(float) * cap, ARENA_ALIGNOF(float));
+    if (!delay)
+      return -1;
+    state->bypass_delay = delay;
+    state->bypass_cap = cap;
+  }
+
+  memset(state->bypass_delay, 0, sizeof(float) * state->bypass_cap);
+  state->bypass_len = len;
+  state->bypass_pos = 0;
+  return 0;
+}
+
+/**
+ * Push a frame into the bypass delay line. When out is given it receives
+ * the input from delay samples earlier; out may alias in. The line always
+ * records bypass_cap samples, so the delay can change between frames
+ * without losing history.
+ */
+static void bypass_delay_run(AudxState *state, const float *in, float *out,
+                             unsigned int delay) {
+  unsigned int cap = state->bypass_cap, pos = state->bypass_pos;
+  unsigned int tap = pos >= delay ? pos - delay : pos + cap - delay;
+  for (unsigned int i = 0; i < state->in_len; i++) {
+    float x = in[i];
+    if (out)
+      out[i] = state->bypass_delay[tap];
+    state->bypass_delay[pos] = x;
+    if (++pos == cap)
+      pos = 0;
+    if (++tap == cap)
+      tap = 0;
+  }
+  state->bypass_pos = pos;
+}
+
+/**
+ * Quality-0 resamplers for REDUCED, created with the state so a mode change
+ * only swaps pointers. Nothing to do at native rate or when the state
+ * already runs at quality 0.
+ */
+static int create_spare_resamplers(AudxState *state) {
+  if (!state->need_resample || state->resample_quality == 0)
+    return 0;
+
+  state->spare_upsampler =
+      audx_resampler_create(state->in_rate, state->proc_rate, 0);
+  state->spare_downsampler =
+      audx_resampler_create(state->proc_rate, state->in_rate, 0);
+  return state->spare_upsampler && state->spare_downsampler ? 0 : -1;
+}
+
+static void swap_resampler(AudxResamplerState **active,
+                           AudxResamplerState **spare) {
+  AudxResamplerState *incoming = *spare;
+  *spare = *active;
+  *active = incoming;
+  // Its history is from the last time it ran.
+  if (incoming)
+    audx_resampler_reset(incoming);
+}
+
+static void swap_resamplers(AudxState *state) {
+  swap_resampler(&state->upsampler, &state->spare_upsampler);
+  swap_resampler(&state->downsampler, &state->spare_downsampler);
+  swap_resampler(&state->echo_resampler, &state->spare_echo_resampler);
+  state->fast_resamplers = !state->fast_resamplers;
+}
+
+/**
+ * The cheapest registered tier, the last one registered, unless that is the
+ * model the state already runs.
+ */
+static AudxDenoiseState *create_reduced_denoiser(const char *model_path) {
+  int index = audx_model_tier_count() - 1;
+  const AudxModelTier *tier = audx_model_tier_get(index);
+  if (!tier)
+    return NULL;
+
+  bool same = tier->model_path && model_path
+                  ? strcmp(tier->model_path, model_path) == 0
+                  : tier->model_path == model_path;
+  return same ? NULL : audx_denoise_create_tier(index);
+}
+
+AudxState *audx_create_with_tenant(char *model_path, unsigned int in_rate,
+                                   int resample_quality, uint32_t tenant_id) {
+  AudxTenant *tenant = audx_tenant_get(tenant_id);
+  if (!tenant)
+    return NULL;
+
+  AudxState *state = audx_create(model_path, in_rate, resample_quality);
+  if (!state)
+    return NULL;
+
+  // Created up front, so a quota change never loads a model on the audio
+  // thread.
+  state->reduced_denoiser = create_reduced_denoiser(model_path);
+  if (create_spare_resamplers(state) != 0 || bypass_delay_init(state) != 0) {
+    audx_destroy(state);
     return NULL;
   }
 
-  state->arena = arena;
+  state->tenant = tenant;
   return state;
 }
 
+// Clear the history of every processing stage.
+static int reset_pipeline(AudxState *state) {
+  int ret = audx_denoise_reset(state->denoiser);
+  if (state->upsampler && audx_resampler_reset(state->upsampler) != 0)
+    ret = -1;
+  if (state->downsampler && audx_resampler_reset(state->downsampler) != 0)
+    ret = -1;
+  if (state->echo) {
+    audx_echo_reset(state->echo);
+    if (state->echo_resampler &&
+        audx_resampler_reset(state->echo_resampler) != 0)
+      ret = -1;
+  }
+  return ret;
+}
+
+static void apply_tenant_mode(AudxState *state, AudxTenantMode mode) {
+  // Bypass keeps the stages and delay of the mode before it, so the switch
+  // into bypass neither drops nor repeats audio.
+  if (mode != AUDX_TENANT_BYPASS) {
+    // The pipeline sat idle while bypassed; resume from clean history
+    // rather than from audio it saw before.
+    if (state->tenant_mode == AUDX_TENANT_BYPASS)
+      reset_pipeline(state);
+
+    bool fast = mode == AUDX_TENANT_REDUCED;
+    if (state->spare_upsampler && fast != state->fast_resamplers)
+      swap_resamplers(state);
+
+    AudxDenoiseState *denoiser = fast && state->reduced_denoiser
+                                     ? state->reduced_denoiser
+                                     : state->full_denoiser;
+    if (denoiser != state->denoiser) {
+      audx_denoise_reset(denoiser);
+      state->denoiser = denoiser;
+    }
+    state->bypass_len = audx_latency(state);
+  }
+  state->tenant_mode = mode;
+}
+
+/**
+ * Tenant accounting brackets each public process call with the thread CPU
+ * clock. States without a tenant pay a single branch.
+ */
+static inline uint64_t tenant_begin(AudxState *state) {
+  if (!state->tenant)
+    return 0;
+
+  AudxTenantMode mode = audx_tenant_current_mode(state->tenant);
+  if (mode != state->tenant_mode)
+    apply_tenant_mode(state, mode);
+  return audx_tenant_clock_ns();
+}
+
+static inline void tenant_end(AudxState *state, uint64_t cpu_t0) {
+  if (state->tenant)
+    audx_tenant_charge(state->tenant, audx_tenant_clock_ns() - cpu_t0);
+}
+
+/**
+ * Stage timing is only taken when tracing is on or the stream publishes
+ * telemetry; otherwise this is a load and a branch.
+ */
+static inline uint64_t stage_begin(const AudxState *state) {
+  if (!state->telemetry &&
+      !atomic_load_explicit(&audx_trace_active, memory_order_relaxed))
+    return 0;
+  return audx_now_ns();
+}
+
+static inline void stage_end(AudxState *state, AudxTraceStage stage,
+                             uint64_t t0) {
+  if (!t0)
+    return;
+
+  uint64_t t1 = audx_now_ns();
+  state->stage_ns[stage] = t1 - t0;
+  if (atomic_load_explicit(&audx_trace_active, memory_order_relaxed))
+    audx_trace_record(stage, t0, t1, state, state->frame_index);
+}
+
+static void frame_end(AudxState *state, uint64_t frame_t0, float vad_prob) {
+  stage_end(state, AUDX_TRACE_FRAME, frame_t0);
+  if (state->telemetry && frame_t0) {
+    audx_telemetry_publish(state->telemetry, state->stage_ns, vad_prob,
+                           vad_prob < 0.0f);
+    memset(state->stage_ns, 0, sizeof(state->stage_ns));
+  }
+  state->echo_far_set = false;
+  state->frame_index++;
+}
+
+static inline void convert_out(AudxState *state, const float *in, short *out,
+                               unsigned int count) {
+  if (state->output_stage_enabled)
+    pcm_float_to_int16_stage(in, out, count, &state->output_stage);
+  else
+    pcm_float_to_int16(in, out, count);
+}
+
+/**
+ * Denoise one frame at the processing rate, cancelling echo first when AEC
+ * is on. The near end is already resampled and framed for the denoiser, so
+ * the canceller shares that work.
+ */
+static float denoise_stage(AudxState *state, float *in, float *out) {
+  uint64_t t0 = stage_begin(state);
+  if (state->echo) {
+    // out is free until the denoiser writes it
+    audx_echo_process(state->echo, in,
+                      state->echo_far_set ? state->echo_far : NULL, out);
+    in = out;
+  }
+  float vad_prob = audx_denoise_process(state->denoiser, in, out);
+  stage_end(state, AUDX_TRACE_DENOISE, t0);
+  return vad_prob;
+}
+
 float audx_process_with_resample(AudxState *state, float *in, float *out) {
   if (!state || !out || !in)
     return -1.0;
 
-  unsigned int frame_size = FRAME_SIZE;
+  unsigned int frame_size = state->proc_len;
   unsigned int in_len = state->in_len;
+  uint64_t t0 = stage_begin(state);
   int ret = audx_resampler_process(state->upsampler, in, &in_len,
                                    state->upsampler_buf, &frame_size);
+  stage_end(state, AUDX_TRACE_UPSAMPLE, t0);
   if (ret < 0) {
     return -1.0;
   }
-  float vad_prob = audx_denoise_process(state->denoiser, state->upsampler_buf,
-                                        state->downsampler_buf);
+
+  float vad_prob =
+      denoise_stage(state, state->upsampler_buf, state->downsampler_buf);
   if (vad_prob < 0.0) {
     return -1.0;
   }
+
+  t0 = stage_begin(state);
   ret = audx_resampler_process(state->downsampler, state->downsampler_buf,
                                &frame_size, out, &in_len);
+  stage_end(state, AUDX_TRACE_DOWNSAMPLE, t0);
   if (ret < 0) {
     return -1.0;
   }
@@ -122,16 +481,36 @@ float audx_process_with_resample(AudxState *state, float *in, float *out) {
   return vad_prob;
 }
 
+/**
+ * Denoise one frame at the input rate, or pass it through the bypass delay
+ * line when the tenant is over quota.
+ */
+static float process_frame(AudxState *state, float *in, float *out) {
+  if (state->tenant) {
+    bool bypass = state->tenant_mode == AUDX_TENANT_BYPASS;
+    bypass_delay_run(state, in, bypass ? out : NULL, state->bypass_len);
+    if (bypass)
+      return 0.0;
+  }
+
+  if (state->need_resample)
+    return audx_process_with_resample(state, in, out);
+
+  return denoise_stage(state, in, out);
+}
+
 float audx_process(AudxState *state, float *in, float *out) {
   if (!state || !out || !in)
     return -1.0;
 
-  float vad_prob = 0.0;
-  if (state->need_resample) {
-    vad_prob = audx_process_with_resample(state, in, out);
-  } else {
-    vad_prob = audx_denoise_process(state->denoiser, in, out);
-  }
+  if (state->capture)
+    audx_capture_write(state->capture, in, state->in_len, AUDX_CAPTURE_F32);
+
+  uint64_t cpu_t0 = tenant_begin(state);
+  uint64_t frame_t0 = stage_begin(state);
+  float vad_prob = process_frame(state, in, out);
+  frame_end(state, frame_t0, vad_prob);
+  tenant_end(state, cpu_t0);
 
   return vad_prob;
 }
@@ -140,31 +519,608 @@ float audx_process_int(AudxState *state, short *in, short *out) {
   if (!state || !in || !out)
     return -1.0;
 
+  if (state->capture)
+    audx_capture_write(state->capture, in, state->in_len, AUDX_CAPTURE_S16);
+
+  uint64_t cpu_t0 = tenant_begin(state);
+  uint64_t frame_t0 = stage_begin(state);
   float vad_prob = 0.0;
   float tmp_in[state->in_len];
-  float tmp_out[FRAME_SIZE];
+  float tmp_out[state->in_len];
+
+  uint64_t t0 = stage_begin(state);
   pcm_int16_to_float(in, tmp_in, state->in_len);
+  stage_end(state, AUDX_TRACE_CONVERT_IN, t0);
 
-  if (state->need_resample) {
-    vad_prob = audx_process_with_resample(state, tmp_in, tmp_out);
+  vad_prob = process_frame(state, tmp_in, tmp_out);
+
+  t0 = stage_begin(state);
+  convert_out(state, tmp_out, out, state->in_len);
+  stage_end(state, AUDX_TRACE_CONVERT_OUT, t0);
+
+  frame_end(state, frame_t0, vad_prob);
+  tenant_end(state, cpu_t0);
+
+  return vad_prob;
+}
+
+static bool view_valid(const AudxBufferView *view) {
+  return view && view->data && view->stride >= 1 &&
+         (view->format == AUDX_BUFFER_S16 || view->format == AUDX_BUFFER_F32);
+}
+
+static void gather_view(const AudxBufferView *in, float *out,
+                        unsigned int count) {
+  if (in->format == AUDX_BUFFER_S16)
+    pcm_int16_to_float_strided(in->data, (int)in->stride, out, (int)count);
+  else if (in->stride == 1)
+    memcpy(out, in->data, sizeof(float) * count);
+  else
+    pcm_float_strided(in->data, (int)in->stride, out, (int)count);
+}
+
+/**
+ * Conversion stays vectorized; only the strided stores are scalar, since a
+ * vector read-modify-write could race with another state writing a
+ * neighbouring channel of the same buffer.
+ */
+static void scatter_view(AudxState *state, const float *in,
+                         const AudxBufferView *out, unsigned int count) {
+  if (out->format == AUDX_BUFFER_F32) {
+    float *dst = out->data;
+    if (out->stride == 1) {
+      memcpy(dst, in, sizeof(float) * count);
+      return;
+    }
+    for (unsigned int i = 0; i < count; i++)
+      dst[(size_t)i * out->stride] = in[i];
+    return;
+  }
+
+  short *dst = out->data;
+  if (out->stride == 1) {
+    convert_out(state, in, dst, count);
+    return;
+  }
+  short tmp[count];
+  convert_out(state, in, tmp, count);
+  for (unsigned int i = 0; i < count; i++)
+    dst[(size_t)i * out->stride] = tmp[i];
+}
+
+float audx_process_view(AudxState *state, const AudxBufferView *in,
+                        const AudxBufferView *out) {
+  if (!state || !view_valid(in) || !view_valid(out))
+    return -1.0;
+
+  // Contiguous views need no gather or scatter.
+  if (in->stride == 1 && out->stride == 1 && in->format == out->format)
+    return in->format == AUDX_BUFFER_F32
+               ? audx_process(state, in->data, out->data)
+               : audx_process_int(state, in->data, out->data);
+
+  uint64_t cpu_t0 = tenant_begin(state);
+  uint64_t frame_t0 = stage_begin(state);
+  float tmp_in[state->in_len];
+  float tmp_out[state->in_len];
+
+  uint64_t t0 = stage_begin(state);
+  gather_view(in, tmp_in, state->in_len);
+  stage_end(state, AUDX_TRACE_CONVERT_IN, t0);
+
+  if (state->capture)
+    audx_capture_write(state->capture, tmp_in, state->in_len,
+                       AUDX_CAPTURE_F32);
+
+  float vad_prob = process_frame(state, tmp_in, tmp_out);
+
+  t0 = stage_begin(state);
+  scatter_view(state, tmp_out, out, state->in_len);
+  stage_end(state, AUDX_TRACE_CONVERT_OUT, t0);
+
+  frame_end(state, frame_t0, vad_prob);
+  tenant_end(state, cpu_t0);
+
+  return vad_prob;
+}
+
+// Fixed, distinct non-zero seeds keep output reproducible across runs.
+static void seed_dither(AudxOutputStage *stage) {
+  for (int l = 0; l < 4; l++)
+    stage->rng[l] = 0x9e3779b9u * (uint32_t)(l + 1);
+}
+
+int audx_set_output_stage(AudxState *state, float gain_db, float ceiling_dbfs,
+                          float knee_db, bool dither) {
+  if (!state || !isfinite(gain_db) || !isfinite(ceiling_dbfs) ||
+      !isfinite(knee_db) || ceiling_dbfs > 0.0f || knee_db < 0.0f)
+    return -1;
+
+  AudxOutputStage *stage = &state->output_stage;
+  stage->gain = powf(10.0f, gain_db / 20.0f);
+  if (knee_db > 0.0f) {
+    float ceiling = PCM_SCALE_FLOAT_MAX * powf(10.0f, ceiling_dbfs / 20.0f);
+    stage->threshold = ceiling * powf(10.0f, -knee_db / 20.0f);
+    stage->inv_range = 1.0f / (ceiling - stage->threshold);
+  } else {
+    stage->threshold = PCM_SCALE_FLOAT_MAX;
+    stage->inv_range = 0.0f;
+  }
+  stage->dither = dither ? 1.0f : 0.0f;
+  seed_dither(stage);
+
+  state->output_stage_enabled = gain_db != 0.0f || knee_db > 0.0f || dither;
+  return 0;
+}
+
+float audx_process_metered(AudxState *state, float *in, float *out,
+                           AudxFrameMetrics *metrics) {
+  if (!state || !in || !out || !metrics)
+    return -1.0;
+
+  pcm_float_meter(in, state->in_len, &metrics->in);
+  metrics->vad_prob = audx_process(state, in, out);
+  pcm_float_meter(out, state->in_len, &metrics->out);
+  return metrics->vad_prob;
+}
+
+float audx_process_int_metered(AudxState *state, short *in, short *out,
+                               AudxFrameMetrics *metrics) {
+  if (!state || !in || !out || !metrics)
+    return -1.0;
+
+  if (state->capture)
+    audx_capture_write(state->capture, in, state->in_len, AUDX_CAPTURE_S16);
+
+  uint64_t cpu_t0 = tenant_begin(state);
+  uint64_t frame_t0 = stage_begin(state);
+  float vad_prob = 0.0;
+  float tmp_in[state->in_len];
+  float tmp_out[state->in_len];
+
+  // Metering rides on the conversion loads, so it costs no extra pass.
+  uint64_t t0 = stage_begin(state);
+  pcm_int16_to_float_meter(in, tmp_in, state->in_len, &metrics->in);
+  stage_end(state, AUDX_TRACE_CONVERT_IN, t0);
+
+  vad_prob = process_frame(state, tmp_in, tmp_out);
+
+  t0 = stage_begin(state);
+  if (state->output_stage_enabled) {
+    // Meter what is actually emitted; costs a pass only in this combination.
+    convert_out(state, tmp_out, out, state->in_len);
+    pcm_int16_to_float_meter(out, tmp_out, state->in_len, &metrics->out);
   } else {
-    vad_prob = audx_denoise_process(state->denoiser, tmp_in, tmp_out);
+    pcm_float_to_int16_meter(tmp_out, out, state->in_len, &metrics->out);
+  }
+  stage_end(state, AUDX_TRACE_CONVERT_OUT, t0);
+
+  frame_end(state, frame_t0, vad_prob);
+  tenant_end(state, cpu_t0);
+
+  metrics->vad_prob = vad_prob;
+  return vad_prob;
+}
+
+static unsigned int gcd(unsigned int a, unsigned int b) {
+  while (b) {
+    unsigned int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+static int asrc_apply_ppm(AudxState *state, double ppm) {
+  unsigned int g = gcd(state->proc_rate, state->in_rate);
+  uint64_t num = state->proc_rate / g;
+  uint64_t den = state->in_rate / g;
+
+  // Keep the scaled ratio within 32 bits for unusual rate pairs.
+  uint64_t scale = ASRC_RATIO_SCALE;
+  uint64_t largest = num > den ? num : den;
+  while (scale > 1 && largest * scale * 2 > UINT32_MAX)
+    scale /= 10;
+
+  uint64_t ratio_num = (uint64_t)llround(num * scale * (1.0 + ppm * 1e-6));
+  uint64_t ratio_den = den * scale;
+  // The spare downsampler tracks the ratio too, ready for a mode change.
+  if (state->spare_downsampler &&
+      audx_resampler_set_rate_frac(state->spare_downsampler,
+                                   (unsigned int)ratio_num,
+                                   (unsigned int)ratio_den, state->proc_rate,
+                                   state->in_rate) < 0)
+    return -1;
+  return audx_resampler_set_rate_frac(
+      state->downsampler, (unsigned int)ratio_num, (unsigned int)ratio_den,
+      state->proc_rate, state->in_rate);
+}
+
+int audx_asrc_enable(AudxState *state, double max_ppm) {
+  if (!state || !(max_ppm > 0.0))
+    return -1;
+
+  // A frame yields in_len * ppm extra samples, plus one for the resampler's
+  // phase. Beyond what the output buffer holds, the resampler would stop
+  // consuming denoised input.
+  if (state->in_len * max_ppm * 1e-6 + 1.0 > AUDX_ASRC_MAX_EXTRA)
+    return -1;
+
+  // Native-rate input has no downsampler yet; add one for the output side.
+  if (!state->downsampler) {
+    state->downsampler_buf =
+        arena_alloc(state->arena, sizeof(float) * state->proc_len,
+                    ARENA_ALIGNOF(float));
+    if (!state->downsampler_buf)
+      return -1;
+
+    state->downsampler = audx_resampler_create(
+        state->proc_rate, state->in_rate, state->resample_quality);
+    if (!state->downsampler)
+      return -1;
+    // Only audx_process_asrc() runs it.
+    state->asrc_delay =
+        (unsigned int)lround(audx_resampler_delay(state->downsampler));
+  }
+
+  // Visit both extremes first: filter and history buffers only grow, so
+  // every later ratio within range reuses them without reallocating.
+  if (asrc_apply_ppm(state, -max_ppm) < 0 ||
+      asrc_apply_ppm(state, max_ppm) < 0 || asrc_apply_ppm(state, 0.0) < 0)
+    return -1;
+
+  // A downsampler added above lengthens the ASRC path.
+  if (state->tenant && bypass_delay_init(state) != 0)
+    return -1;
+
+  state->asrc_max_ppm = max_ppm;
+  state->asrc_ppm = 0.0;
+  state->asrc_integral = 0.0;
+  state->asrc_enabled = true;
+  return 0;
+}
+
+int audx_asrc_set_ppm(AudxState *state, double ppm) {
+  if (!state || !state->asrc_enabled)
+    return -1;
+
+  if (ppm > state->asrc_max_ppm)
+    ppm = state->asrc_max_ppm;
+  if (ppm < -state->asrc_max_ppm)
+    ppm = -state->asrc_max_ppm;
+
+  if (asrc_apply_ppm(state, ppm) < 0)
+    return -1;
+
+  state->asrc_ppm = ppm;
+  return 0;
+}
+
+double audx_asrc_update(AudxState *state, int fill_level, int target_fill) {
+  if (!state || !state->asrc_enabled)
+    return 0.0;
+
+  // Proportional gain removes an error of one sample over
+  // ASRC_CORRECTION_FRAMES frames.
+  double kp = 1e6 / (state->in_len * ASRC_CORRECTION_FRAMES);
+  double ki = kp * ASRC_INTEGRAL_RATIO;
+  double error = (double)(fill_level - target_fill);
+
+  // Anti-windup: the integral term alone never exceeds the ppm range.
+  state->asrc_integral += error;
+  double limit = state->asrc_max_ppm / ki;
+  if (state->asrc_integral > limit)
+    state->asrc_integral = limit;
+  if (state->asrc_integral < -limit)
+    state->asrc_integral = -limit;
+
+  audx_asrc_set_ppm(state, kp * error + ki * state->asrc_integral);
+  return state->asrc_ppm;
+}
+
+static float process_asrc_frame(AudxState *state, float *in, float *out,
+                                unsigned int *out_len) {
+  if (state->tenant) {
+    bool bypass = state->tenant_mode == AUDX_TENANT_BYPASS;
+    bypass_delay_run(state, in, bypass ? out : NULL,
+                     state->bypass_len + state->asrc_delay);
+    if (bypass) {
+      *out_len = state->in_len;
+      return 0.0;
+    }
+  }
+
+  unsigned int frame_size = state->proc_len;
+  unsigned int in_len = state->in_len;
+  float *denoise_in = in;
+
+  uint64_t t0;
+  if (state->upsampler) {
+    t0 = stage_begin(state);
+    int ret = audx_resampler_process(state->upsampler, in, &in_len,
+                                     state->upsampler_buf, &frame_size);
+    stage_end(state, AUDX_TRACE_UPSAMPLE, t0);
+    if (ret < 0)
+      return -1.0;
+    denoise_in = state->upsampler_buf;
   }
 
-  pcm_float_to_int16(tmp_out, out, state->in_len);
+  float vad_prob = denoise_stage(state, denoise_in, state->downsampler_buf);
+  if (vad_prob < 0.0)
+    return -1.0;
+
+  t0 = stage_begin(state);
+  unsigned int denoised = frame_size;
+  *out_len = state->in_len + AUDX_ASRC_MAX_EXTRA;
+  int ret = audx_resampler_process(state->downsampler, state->downsampler_buf,
+                                   &frame_size, out, out_len);
+  stage_end(state, AUDX_TRACE_DOWNSAMPLE, t0);
+  // audx_asrc_enable() bounds the ratio so the whole frame always fits;
+  // never drop denoised audio silently.
+  if (ret < 0 || frame_size != denoised)
+    return -1.0;
+
+  return vad_prob;
+}
+
+float audx_process_asrc(AudxState *state, float *in, float *out,
+                        unsigned int *out_len) {
+  if (!state || !in || !out || !out_len || !state->asrc_enabled)
+    return -1.0;
+
+  if (state->capture)
+    audx_capture_write(state->capture, in, state->in_len, AUDX_CAPTURE_F32);
+
+  uint64_t cpu_t0 = tenant_begin(state);
+  uint64_t frame_t0 = stage_begin(state);
+  float vad_prob = process_asrc_frame(state, in, out, out_len);
+  frame_end(state, frame_t0, vad_prob);
+  tenant_end(state, cpu_t0);
+
+  return vad_prob;
+}
+
+float audx_process_asrc_int(AudxState *state, short *in, short *out,
+                            unsigned int *out_len) {
+  if (!state || !in || !out || !out_len || !state->asrc_enabled)
+    return -1.0;
+
+  if (state->capture)
+    audx_capture_write(state->capture, in, state->in_len, AUDX_CAPTURE_S16);
+
+  uint64_t cpu_t0 = tenant_begin(state);
+  uint64_t frame_t0 = stage_begin(state);
+  float tmp_in[state->in_len];
+  float tmp_out[state->in_len + AUDX_ASRC_MAX_EXTRA];
+
+  uint64_t t0 = stage_begin(state);
+  pcm_int16_to_float(in, tmp_in, state->in_len);
+  stage_end(state, AUDX_TRACE_CONVERT_IN, t0);
+
+  float vad_prob = process_asrc_frame(state, tmp_in, tmp_out, out_len);
+  if (vad_prob >= 0.0) {
+    t0 = stage_begin(state);
+    convert_out(state, tmp_out, out, *out_len);
+    stage_end(state, AUDX_TRACE_CONVERT_OUT, t0);
+  }
 
+  frame_end(state, frame_t0, vad_prob);
+  tenant_end(state, cpu_t0);
   return vad_prob;
 }
 
+int audx_aec_enable(AudxState *state, unsigned int tail_ms) {
+  if (!state || state->echo)
+    return -1;
+  if (tail_ms == 0)
+    tail_ms = AUDX_AEC_DEFAULT_TAIL_MS;
+
+  state->echo_far = arena_alloc(state->arena, sizeof(short) * state->proc_len,
+                                ARENA_ALIGNOF(short));
+  if (!state->echo_far)
+    return -1;
+
+  // Only the reference needs a resampler of its own; the near end reuses
+  // the denoiser's upsampler.
+  if (state->need_resample && !state->echo_resampler) {
+    state->echo_resampler = audx_resampler_create(
+        state->in_rate, state->proc_rate,
+        state->fast_resamplers ? 0 : state->resample_quality);
+    if (!state->echo_resampler)
+      return -1;
+
+    // The other quality, for tenant mode changes like the other resamplers.
+    if (state->spare_upsampler) {
+      state->spare_echo_resampler = audx_resampler_create(
+          state->in_rate, state->proc_rate,
+          state->fast_resamplers ? state->resample_quality : 0);
+      if (!state->spare_echo_resampler)
+        return -1;
+    }
+  }
+
+  state->echo = audx_echo_create(state->proc_rate, state->proc_len, tail_ms);
+  if (!state->echo)
+    return -1;
+
+  state->echo_far_set = false;
+  return 0;
+}
+
+/**
+ * Bring a far-end frame to the processing rate for the next frame's echo
+ * cancellation.
+ */
+static int load_echo_far(AudxState *state, const float *far) {
+  if (!state->echo_resampler) {
+    pcm_float_to_int16(far, state->echo_far, (int)state->proc_len);
+    state->echo_far_set = true;
+    return 0;
+  }
+
+  float tmp[state->proc_len];
+  unsigned int in_len = state->in_len;
+  unsigned int out_len = state->proc_len;
+  if (audx_resampler_process(state->echo_resampler, far, &in_len, tmp,
+                             &out_len) < 0)
+    return -1;
+
+  pcm_float_to_int16(tmp, state->echo_far, (int)out_len);
+  memset(state->echo_far + out_len, 0,
+         sizeof(short) * (state->proc_len - out_len));
+  state->echo_far_set = true;
+  return 0;
+}
+
+float audx_process_aec(AudxState *state, float *in, const float *far,
+                       float *out) {
+  if (!state || !in || !far || !out || !state->echo)
+    return -1.0;
+
+  if (load_echo_far(state, far) != 0)
+    return -1.0;
+  return audx_process(state, in, out);
+}
+
+float audx_process_aec_int(AudxState *state, short *in, const short *far,
+                           short *out) {
+  if (!state || !in || !far || !out || !state->echo)
+    return -1.0;
+
+  if (!state->echo_resampler) {
+    memcpy(state->echo_far, far, sizeof(short) * state->proc_len);
+    state->echo_far_set = true;
+  } else {
+    float tmp[state->in_len];
+    pcm_int16_to_float(far, tmp, (int)state->in_len);
+    if (load_echo_far(state, tmp) != 0)
+      return -1.0;
+  }
+  return audx_process_int(state, in, out);
+}
+
+int audx_state_lock_memory(AudxState *state) {
+  if (!state)
+    return -1;
+
+  int ret = audx_denoise_lock_memory(state->full_denoiser);
+  if (state->reduced_denoiser &&
+      audx_denoise_lock_memory(state->reduced_denoiser) != 0)
+    ret = -1;
+  for (struct ArenaBlock *block = state->arena->head; block;
+       block = block->next) {
+    if (mlock(block, sizeof(*block) + block->capacity) != 0)
+      ret = -1;
+  }
+  return ret;
+}
+
+// Enough frames for the resampler filters and the denoiser's GRU history to
+// reach steady state, and for the branch predictors to settle.
+#define AUDX_WARMUP_DEFAULT_FRAMES 20
+
+int audx_warmup(AudxState *state, unsigned int nframes) {
+  if (!state)
+    return -1;
+  if (nframes == 0)
+    nframes = AUDX_WARMUP_DEFAULT_FRAMES;
+
+  short in[state->in_len];
+  short out[state->in_len + AUDX_ASRC_MAX_EXTRA];
+  float tmp_in[state->in_len];
+  float tmp_out[state->in_len + AUDX_ASRC_MAX_EXTRA];
+
+  // Low-level noise rather than silence, so every kernel does real work.
+  uint32_t seed = 0x2545f491u;
+  int ret = 0;
+
+  for (unsigned int f = 0; f < nframes && ret == 0; f++) {
+    for (unsigned int i = 0; i < state->in_len; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      in[i] = (short)((int32_t)(seed >> 16) - 32768) / 64;
+    }
+
+    // Same kernels as the public paths, without tracing, capture,
+    // telemetry or tenant accounting.
+    pcm_int16_to_float(in, tmp_in, state->in_len);
+    unsigned int out_len = state->in_len;
+    float vad_prob = state->asrc_enabled
+                         ? process_asrc_frame(state, tmp_in, tmp_out, &out_len)
+                         : process_frame(state, tmp_in, tmp_out);
+    if (vad_prob < 0.0f)
+      ret = -1;
+    else
+      convert_out(state, tmp_out, out, out_len);
+  }
+
+  if (audx_reset(state) != 0)
+    ret = -1;
+  return ret;
+}
+
+int audx_reset(AudxState *state) {
+  if (!state)
+    return -1;
+
+  int ret = reset_pipeline(state);
+  if (state->bypass_delay) {
+    memset(state->bypass_delay, 0, sizeof(float) * state->bypass_cap);
+    state->bypass_pos = 0;
+  }
+
+  seed_dither(&state->output_stage);
+  state->frame_index = 0;
+  memset(state->stage_ns, 0, sizeof(state->stage_ns));
+  return ret;
+}
+
+unsigned int audx_latency(const AudxState *state) {
+  if (!state)
+    return 0;
+
+  return pipeline_latency(state, state->upsampler, state->downsampler);
+}
+
+unsigned int audx_asrc_latency(const AudxState *state) {
+  if (!state)
+    return 0;
+
+  return audx_latency(state) + state->asrc_delay;
+}
+
+int audx_capture_attach(AudxState *state, AudxCapture *capture,
+                        uint32_t stream_id) {
+  if (!state || !capture || state->capture)
+    return -1;
+
+  state->capture = audx_capture_ring_create(capture, stream_id, state->in_rate);
+  return state->capture ? 0 : -1;
+}
+
+void audx_capture_detach(AudxState *state) {
+  if (!state || !state->capture)
+    return;
+
+  audx_capture_ring_release(state->capture);
+  state->capture = NULL;
+}
+
 void audx_destroy(AudxState *state) {
   if (!state)
     return;
 
-  audx_denoise_destroy(state->denoiser);
-  if (state->in_rate != FRAME_RATE) {
-    audx_resampler_destroy(state->upsampler);
-    audx_resampler_destroy(state->downsampler);
-  }
+  audx_capture_detach(state);
+
+  audx_telemetry_detach(state->telemetry);
+  audx_denoise_destroy(state->full_denoiser);
+  audx_denoise_destroy(state->reduced_denoiser);
+  audx_resampler_destroy(state->upsampler);
+  audx_resampler_destroy(state->downsampler);
+  audx_echo_destroy(state->echo);
+  audx_resampler_destroy(state->echo_resampler);
+  audx_resampler_destroy(state->spare_upsampler);
+  audx_resampler_destroy(state->spare_downsampler);
+  audx_resampler_destroy(state->spare_echo_resampler);
 
   arena_free(state->arena);
 }
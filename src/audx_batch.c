@@ -0,0 +1,214 @@
+#include "audx_batch.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Resample quality of cached states; batch work favours quality over speed.
+#define BATCH_RESAMPLE_QUALITY 5
+
+typedef struct BatchEntry {
+  AudxState *state; // NULL when the slot is free
+  char *model_path; // NULL for the built-in model
+  unsigned int rate;
+  unsigned int delay; // audx_latency() of the state
+  uint64_t last_used;
+} BatchEntry;
+
+typedef struct BatchCache {
+  BatchEntry entries[AUDX_BATCH_CACHE_SIZE];
+  uint64_t tick;
+} BatchCache;
+
+static _Thread_local BatchCache *tls_cache = NULL;
+static pthread_key_t cache_key;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+static void entry_clear(BatchEntry *entry) {
+  audx_destroy(entry->state);
+  free(entry->model_path);
+  memset(entry, 0, sizeof(*entry));
+}
+
+static void release_cache(void *ptr) {
+  BatchCache *cache = ptr;
+  if (!cache)
+    return;
+
+  for (int i = 0; i < AUDX_BATCH_CACHE_SIZE; i++)
+    entry_clear(&cache->entries[i]);
+  free(cache);
+}
+
+static void make_key(void) { pthread_key_create(&cache_key, release_cache); }
+
+static BatchCache *get_cache(void) {
+  if (tls_cache)
+    return tls_cache;
+
+  pthread_once(&cache_key_once, make_key);
+  BatchCache *cache = calloc(1, sizeof(BatchCache));
+  if (!cache)
+    return NULL;
+
+  pthread_setspecific(cache_key, cache);
+  tls_cache = cache;
+  return cache;
+}
+
+static bool same_model(const char *a, const char *b) {
+  if (!a || !b)
+    return a == b;
+  return strcmp(a, b) == 0;
+}
+
+/**
+ * Find a cached state for (model, rate) and reset it, or create one in the
+ * least recently used slot. New states are warmed up once here, so later
+ * calls only pay for the reset.
+ */
+static BatchEntry *acquire_entry(BatchCache *cache, const char *model_path,
+                                 unsigned int rate) {
+  BatchEntry *victim = &cache->entries[0];
+  for (int i = 0; i < AUDX_BATCH_CACHE_SIZE; i++) {
+    BatchEntry *entry = &cache->entries[i];
+    if (entry->state && entry->rate == rate &&
+        same_model(entry->model_path, model_path)) {
+      if (audx_reset(entry->state) != 0) {
+        entry_clear(entry);
+        return NULL;
+      }
+      entry->last_used = ++cache->tick;
+      return entry;
+    }
+    if (!entry->state ||
+        (victim->state && entry->last_used < victim->last_used))
+      victim = entry;
+  }
+
+  entry_clear(victim);
+  if (model_path) {
+    victim->model_path = strdup(model_path);
+    if (!victim->model_path)
+      return NULL;
+  }
+
+  victim->state =
+      audx_create(victim->model_path, rate, BATCH_RESAMPLE_QUALITY);
+  if (!victim->state || audx_warmup(victim->state, 0) != 0) {
+    entry_clear(victim);
+    return NULL;
+  }
+
+  victim->rate = rate;
+  victim->delay = audx_latency(victim->state);
+  victim->last_used = ++cache->tick;
+  return victim;
+}
+
+int audx_denoise_buffer(const char *model_path, const void *in, size_t n,
+                        unsigned int rate, AudxBufferFormat format, void *out,
+                        float *vad_track) {
+  // The frame length sizes the scratch buffers below, so bound it before
+  // any state is created for the rate.
+  const size_t len = calculate_frame_sample(rate);
+  if (!in || !out || len == 0 || len > AUDX_BATCH_MAX_FRAME ||
+      (format != AUDX_BUFFER_S16 && format != AUDX_BUFFER_F32))
+    return -1;
+  if (n == 0)
+    return 0;
+
+  BatchCache *cache = get_cache();
+  if (!cache)
+    return -1;
+
+  BatchEntry *entry = acquire_entry(cache, model_path, rate);
+  if (!entry)
+    return -1;
+
+  const size_t sample_size =
+      format == AUDX_BUFFER_S16 ? sizeof(short) : sizeof(float);
+  const size_t vad_frames = audx_denoise_buffer_frames(n, rate);
+  // Frames are pushed until the delayed output covers the whole input.
+  const size_t total = n + entry->delay;
+  const size_t frames = (total + len - 1) / len;
+
+  // Float-sized scratch fits either format.
+  float frame_in[AUDX_BATCH_MAX_FRAME];
+  float frame_out[AUDX_BATCH_MAX_FRAME];
+
+  // Accumulates each frame's VAD weighted by the samples it contributes.
+  if (vad_track)
+    memset(vad_track, 0, sizeof(float) * vad_frames);
+
+  for (size_t f = 0; f < frames; f++) {
+    size_t pos = f * len;
+
+    // Full frames are read in place; the tail is zero padded in scratch.
+    // Input is always consumed ahead of the delayed output, so out may
+    // alias in.
+    void *src = frame_in;
+    if (pos + len <= n) {
+      src = (void *)((const unsigned char *)in + pos * sample_size);
+    } else {
+      size_t avail = pos < n ? n - pos : 0;
+      if (avail)
+        memcpy(frame_in, (const unsigned char *)in + pos * sample_size,
+               avail * sample_size);
+      memset((unsigned char *)frame_in + avail * sample_size, 0,
+             (len - avail) * sample_size);
+    }
+
+    float vad_prob =
+        format == AUDX_BUFFER_S16
+            ? audx_process_int(entry->state, src, (short *)frame_out)
+            : audx_process(entry->state, src, frame_out);
+    if (vad_prob < 0.0f)
+      return -1;
+
+    // Output sample i of this frame is input sample pos + i - delay.
+    size_t skip = pos < entry->delay ? entry->delay - pos : 0;
+    if (skip >= len)
+      continue;
+    size_t dst = pos + skip - entry->delay;
+
+    size_t count = len - skip;
+    if (dst + count > n)
+      count = n - dst;
+    memcpy((unsigned char *)out + dst * sample_size,
+           (unsigned char *)frame_out + skip * sample_size,
+           count * sample_size);
+
+    // The VAD belongs to the same delayed samples as the audio, which may
+    // straddle two input frames.
+    if (vad_track) {
+      for (size_t i = dst; i < dst + count;) {
+        size_t k = i / len;
+        size_t end = (k + 1) * len < dst + count ? (k + 1) * len : dst + count;
+        vad_track[k] += vad_prob * (float)(end - i);
+        i = end;
+      }
+    }
+  }
+
+  // Every input sample is covered once, so dividing by the frame length
+  // gives the average; the last frame may be partial.
+  if (vad_track) {
+    for (size_t k = 0; k < vad_frames; k++) {
+      size_t frame_len = k + 1 < vad_frames ? len : n - k * len;
+      vad_track[k] /= (float)frame_len;
+    }
+  }
+
+  return 0;
+}
+
+void audx_denoise_buffer_release(void) {
+  BatchCache *cache = tls_cache;
+  if (!cache)
+    return;
+
+  pthread_setspecific(cache_key, NULL);
+  tls_cache = NULL;
+  release_cache(cache);
+}
@@ -0,0 +1,231 @@
+#define AUDX_CAPTURE_INTERNAL
+#include "audx_capture.h"
+#include "audx_time.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CAPTURE_DRAIN_INTERVAL_NS 10000000L
+#define CAPTURE_MIN_RING_BYTES 4096u
+
+/**
+ * Single-producer/single-consumer byte ring. Records are published whole by
+ * advancing head, so the drain thread never sees a partial record.
+ */
+struct AudxCaptureRing {
+  struct AudxCaptureRing *next;
+  AudxCapture *capture;
+  uint32_t stream_id;
+  uint32_t sample_rate;
+  size_t mask;
+  atomic_size_t head; // written by producer
+  atomic_size_t tail; // written by drain thread
+  atomic_bool released;
+  uint8_t *data;
+};
+
+struct AudxCapture {
+  FILE *file;
+  size_t ring_bytes;
+  pthread_t thread;
+  pthread_mutex_t lock; // protects rings list
+  AudxCaptureRing *rings;
+  atomic_bool running;
+  atomic_uint_fast64_t dropped;
+};
+
+static size_t next_pow2(size_t n) {
+  size_t p = CAPTURE_MIN_RING_BYTES;
+  while (p < n)
+    p <<= 1;
+  return p;
+}
+
+static void ring_copy_in(AudxCaptureRing *ring, size_t pos, const void *src,
+                         size_t len) {
+  size_t offset = pos & ring->mask;
+  size_t first = ring->mask + 1 - offset;
+  if (first > len)
+    first = len;
+  memcpy(ring->data + offset, src, first);
+  memcpy(ring->data, (const uint8_t *)src + first, len - first);
+}
+
+void audx_capture_write(AudxCaptureRing *ring, const void *samples,
+                        uint32_t count, AudxCaptureFormat format) {
+  size_t payload = (size_t)count * (format == AUDX_CAPTURE_F32 ? 4 : 2);
+  size_t needed = sizeof(AudxCaptureRecord) + payload;
+
+  size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  if (needed > ring->mask + 1 - (head - tail)) {
+    atomic_fetch_add_explicit(&ring->capture->dropped, 1,
+                              memory_order_relaxed);
+    return;
+  }
+
+  AudxCaptureRecord record = {
+      .timestamp_ns = audx_now_ns(),
+      .stream_id = ring->stream_id,
+      .sample_rate = ring->sample_rate,
+      .format = format,
+      .samples = count,
+  };
+  ring_copy_in(ring, head, &record, sizeof(record));
+  ring_copy_in(ring, head + sizeof(record), samples, payload);
+
+  atomic_store_explicit(&ring->head, head + needed, memory_order_release);
+}
+
+static void drain_ring(AudxCapture *capture, AudxCaptureRing *ring) {
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  if (head == tail)
+    return;
+
+  size_t offset = tail & ring->mask;
+  size_t len = head - tail;
+  size_t first = ring->mask + 1 - offset;
+  if (first > len)
+    first = len;
+
+  fwrite(ring->data + offset, 1, first, capture->file);
+  fwrite(ring->data, 1, len - first, capture->file);
+  atomic_store_explicit(&ring->tail, head, memory_order_release);
+}
+
+static void drain_all(AudxCapture *capture) {
+  pthread_mutex_lock(&capture->lock);
+
+  AudxCaptureRing **link = &capture->rings;
+  while (*link) {
+    AudxCaptureRing *ring = *link;
+    // Check release before draining, so nothing written after it is lost.
+    bool released = atomic_load_explicit(&ring->released, memory_order_acquire);
+    drain_ring(capture, ring);
+
+    if (released) {
+      *link = ring->next;
+      free(ring->data);
+      free(ring);
+    } else {
+      link = &ring->next;
+    }
+  }
+
+  pthread_mutex_unlock(&capture->lock);
+  fflush(capture->file);
+}
+
+static void *drain_main(void *arg) {
+  AudxCapture *capture = arg;
+  struct timespec interval = {0, CAPTURE_DRAIN_INTERVAL_NS};
+  while (atomic_load(&capture->running)) {
+    nanosleep(&interval, NULL);
+    drain_all(capture);
+  }
+  return NULL;
+}
+
+AudxCapture *audx_capture_open(const char *path, size_t ring_bytes) {
+  if (!path)
+    return NULL;
+
+  AudxCapture *capture = calloc(1, sizeof(AudxCapture));
+  if (!capture)
+    return NULL;
+
+  capture->file = fopen(path, "wb");
+  if (!capture->file) {
+    free(capture);
+    return NULL;
+  }
+
+  AudxCaptureFileHeader header = {
+      .magic = AUDX_CAPTURE_MAGIC,
+      .version = AUDX_CAPTURE_VERSION,
+      .record_size = sizeof(AudxCaptureRecord),
+  };
+  fwrite(&header, sizeof(header), 1, capture->file);
+
+  capture->ring_bytes = next_pow2(ring_bytes);
+  pthread_mutex_init(&capture->lock, NULL);
+  atomic_init(&capture->dropped, 0);
+  atomic_init(&capture->running, true);
+
+  if (pthread_create(&capture->thread, NULL, drain_main, capture) != 0) {
+    pthread_mutex_destroy(&capture->lock);
+    fclose(capture->file);
+    free(capture);
+    return NULL;
+  }
+
+  return capture;
+}
+
+AudxCaptureRing *audx_capture_ring_create(AudxCapture *capture,
+                                          uint32_t stream_id,
+                                          uint32_t sample_rate) {
+  if (!capture)
+    return NULL;
+
+  AudxCaptureRing *ring = calloc(1, sizeof(AudxCaptureRing));
+  if (!ring)
+    return NULL;
+
+  ring->data = malloc(capture->ring_bytes);
+  if (!ring->data) {
+    free(ring);
+    return NULL;
+  }
+
+  ring->capture = capture;
+  ring->stream_id = stream_id;
+  ring->sample_rate = sample_rate;
+  ring->mask = capture->ring_bytes - 1;
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  atomic_init(&ring->released, false);
+
+  pthread_mutex_lock(&capture->lock);
+  ring->next = capture->rings;
+  capture->rings = ring;
+  pthread_mutex_unlock(&capture->lock);
+  return ring;
+}
+
+void audx_capture_ring_release(AudxCaptureRing *ring) {
+  if (ring)
+    atomic_store_explicit(&ring->released, true, memory_order_release);
+}
+
+uint64_t audx_capture_dropped(const AudxCapture *capture) {
+  return capture ? atomic_load(&capture->dropped) : 0;
+}
+
+void audx_capture_close(AudxCapture *capture) {
+  if (!capture)
+    return;
+
+  atomic_store(&capture->running, false);
+  pthread_join(capture->thread, NULL);
+
+  // Final pass writes whatever is left and frees released rings.
+  drain_all(capture);
+
+  AudxCaptureRing *ring = capture->rings;
+  while (ring) {
+    AudxCaptureRing *next = ring->next;
+    free(ring->data);
+    free(ring);
+    ring = next;
+  }
+
+  pthread_mutex_destroy(&capture->lock);
+  fclose(capture->file);
+  free(capture);
+}
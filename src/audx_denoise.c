@@ -1,32 +1,110 @@
 #include "audx_denoise.h"
+#include "audx_common.h"
+#include "audx_time.h"
 #include "rnnoise.h"
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+
+/**
+ * A model file loaded once and shared read-only by every denoiser created
+ * from the same path. RNNoise points its layers into the model's weight
+ * blob, so the blob only has to outlive the states using it.
+ */
+typedef struct SharedModel {
+  struct SharedModel *next;
+  char *path;
+  RNNModel *model;
+  unsigned int refs;
+} SharedModel;
+
+static pthread_mutex_t model_lock = PTHREAD_MUTEX_INITIALIZER;
+static SharedModel *shared_models = NULL;
 
 struct AudxDenoiseState {
   DenoiseState *st;
-  RNNModel *model;
+  SharedModel *model; // NULL for the built-in model
+  unsigned int sample_rate;
+  unsigned int frame_size;
 };
 
-AudxDenoiseState *audx_denoise_create(char *model_path) {
-  DenoiseState *st = NULL;
-  RNNModel *model = NULL;
+static SharedModel *model_acquire(const char *path) {
+  pthread_mutex_lock(&model_lock);
+  SharedModel *shared = shared_models;
+  while (shared && strcmp(shared->path, path) != 0)
+    shared = shared->next;
 
-  if (model_path) {
-    model = rnnoise_model_from_filename(model_path);
-    st = rnnoise_create(model);
-  } else {
-    st = rnnoise_create(NULL);
+  if (shared) {
+    shared->refs++;
+    pthread_mutex_unlock(&model_lock);
+    return shared;
   }
 
+  // Loading under the lock keeps concurrent creates from loading twice.
+  shared = calloc(1, sizeof(SharedModel));
+  if (shared) {
+    shared->path = strdup(path);
+    shared->model = shared->path ? rnnoise_model_from_filename(path) : NULL;
+    if (!shared->model) {
+      free(shared->path);
+      free(shared);
+      shared = NULL;
+    }
+  }
+  if (shared) {
+    shared->refs = 1;
+    shared->next = shared_models;
+    shared_models = shared;
+  }
+  pthread_mutex_unlock(&model_lock);
+  return shared;
+}
+
+static void model_release(SharedModel *shared) {
+  if (!shared)
+    return;
+
+  pthread_mutex_lock(&model_lock);
+  bool last = --shared->refs == 0;
+  if (last) {
+    SharedModel **link = &shared_models;
+    while (*link != shared)
+      link = &(*link)->next;
+    *link = shared->next;
+  }
+  pthread_mutex_unlock(&model_lock);
+
+  if (last) {
+    rnnoise_model_free(shared->model);
+    free(shared->path);
+    free(shared);
+  }
+}
+
+static RNNModel *model_of(const AudxDenoiseState *state) {
+  return state->model ? state->model->model : NULL;
+}
+
+AudxDenoiseState *audx_denoise_create(char *model_path) {
   AudxDenoiseState *state = malloc(sizeof(AudxDenoiseState));
   if (!state)
     return NULL;
 
-  state->st = st;
-  state->model = model;
+  // A model that fails to load falls back to the built-in one.
+  state->model = model_path ? model_acquire(model_path) : NULL;
+  state->st = rnnoise_create(model_of(state));
+  if (!state->st) {
+    model_release(state->model);
+    free(state);
+    return NULL;
+  }
+
+  // RNNoise's band layout and network are defined for 48kHz only.
+  state->sample_rate = SAMPLE_RATE;
+  state->frame_size = rnnoise_get_frame_size();
   return state;
 }
 
@@ -38,14 +116,178 @@ float audx_denoise_process(AudxDenoiseState *state, float *in, float *out) {
   return rnnoise_process_frame(state->st, out, in);
 }
 
+unsigned int audx_denoise_sample_rate(const AudxDenoiseState *state) {
+  return state ? state->sample_rate : 0;
+}
+
+unsigned int audx_denoise_frame_size(const AudxDenoiseState *state) {
+  return state ? state->frame_size : 0;
+}
+
+unsigned int audx_denoise_latency(const AudxDenoiseState *state) {
+  if (!state)
+    return 0;
+
+  // RNNoise overlaps each analysis window with the previous frame, so its
+  // output trails the input by exactly one frame.
+  return state->frame_size;
+}
+
+int audx_denoise_reset(AudxDenoiseState *state) {
+  if (!state) {
+    return -1;
+  }
+
+  if (rnnoise_init(state->st, model_of(state)) != 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+int audx_denoise_lock_memory(AudxDenoiseState *state) {
+  if (!state) {
+    return -1;
+  }
+
+  if (mlock(state, sizeof(*state)) != 0 ||
+      mlock(state->st, (size_t)rnnoise_get_size()) != 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
 void audx_denoise_destroy(AudxDenoiseState *state) {
   if (!state) {
     return;
   }
 
   rnnoise_destroy(state->st);
-  if (state->model)
-    rnnoise_model_free(state->model);
+  model_release(state->model);
 
   free(state);
 }
+
+// Frames used to measure tier cost, after a short warm-up.
+#define TIER_WARMUP_FRAMES 20
+#define TIER_MEASURE_FRAMES 200
+
+typedef struct TierEntry {
+  AudxModelTier tier;
+  float cost_us; // < 0 until measured
+} TierEntry;
+
+static pthread_mutex_t tier_lock = PTHREAD_MUTEX_INITIALIZER;
+static TierEntry tiers[AUDX_MAX_MODEL_TIERS] = {
+    {{"default", NULL}, -1.0f},
+};
+static int tier_count = 1;
+
+int audx_model_tier_register(const char *name, const char *model_path) {
+  if (!name || !model_path)
+    return -1;
+
+  RNNModel *model = rnnoise_model_from_filename(model_path);
+  if (!model)
+    return -1;
+  rnnoise_model_free(model);
+
+  char *name_copy = strdup(name);
+  char *path_copy = strdup(model_path);
+  if (!name_copy || !path_copy) {
+    free(name_copy);
+    free(path_copy);
+    return -1;
+  }
+
+  pthread_mutex_lock(&tier_lock);
+  int index = -1;
+  if (tier_count < AUDX_MAX_MODEL_TIERS) {
+    index = tier_count++;
+    tiers[index].tier.name = name_copy;
+    tiers[index].tier.model_path = path_copy;
+    tiers[index].cost_us = -1.0f;
+  }
+  pthread_mutex_unlock(&tier_lock);
+
+  if (index < 0) {
+    free(name_copy);
+    free(path_copy);
+  }
+  return index;
+}
+
+int audx_model_tier_count(void) {
+  pthread_mutex_lock(&tier_lock);
+  int count = tier_count;
+  pthread_mutex_unlock(&tier_lock);
+  return count;
+}
+
+const AudxModelTier *audx_model_tier_get(int index) {
+  if (index < 0 || index >= audx_model_tier_count())
+    return NULL;
+  return &tiers[index].tier;
+}
+
+AudxDenoiseState *audx_denoise_create_tier(int index) {
+  const AudxModelTier *tier = audx_model_tier_get(index);
+  if (!tier)
+    return NULL;
+  return audx_denoise_create((char *)tier->model_path);
+}
+
+static float measure_tier(int index) {
+  AudxDenoiseState *state = audx_denoise_create_tier(index);
+  if (!state)
+    return -1.0f;
+
+  // White noise at a typical speech level keeps the network fully busy.
+  float in[FRAME_SIZE];
+  float out[FRAME_SIZE];
+  uint32_t seed = 0x2545F491u;
+  for (int i = 0; i < FRAME_SIZE; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    in[i] = (float)((int32_t)(seed >> 16) - 32768) / 8.0f;
+  }
+
+  for (int i = 0; i < TIER_WARMUP_FRAMES; i++)
+    audx_denoise_process(state, in, out);
+
+  uint64_t start = audx_now_ns();
+  for (int i = 0; i < TIER_MEASURE_FRAMES; i++)
+    audx_denoise_process(state, in, out);
+  uint64_t elapsed = audx_now_ns() - start;
+
+  audx_denoise_destroy(state);
+  return (float)(elapsed / 1e3 / TIER_MEASURE_FRAMES);
+}
+
+float audx_model_tier_cost_us(int index) {
+  if (index < 0 || index >= audx_model_tier_count())
+    return -1.0f;
+
+  pthread_mutex_lock(&tier_lock);
+  float cost = tiers[index].cost_us;
+  pthread_mutex_unlock(&tier_lock);
+  if (cost >= 0.0f)
+    return cost;
+
+  cost = measure_tier(index);
+
+  pthread_mutex_lock(&tier_lock);
+  tiers[index].cost_us = cost;
+  pthread_mutex_unlock(&tier_lock);
+  return cost;
+}
+
+int audx_model_tier_select(float budget_us) {
+  int count = audx_model_tier_count();
+  for (int i = 0; i < count; i++) {
+    float cost = audx_model_tier_cost_us(i);
+    if (cost >= 0.0f && cost <= budget_us)
+      return i;
+  }
+  return -1;
+}
@@ -0,0 +1,61 @@
+#include "audx_echo.h"
+#include "audx.h"
+#include "speex/speex_echo.h"
+#include <stdlib.h>
+
+struct AudxEchoState {
+  SpeexEchoState *st;
+  unsigned int frame_size;
+  // The SpeexDSP API is int16 even in floating-point builds.
+  short *near;
+  short *silence; // Reference for frames without one
+  short *out;
+};
+
+AudxEchoState *audx_echo_create(unsigned int sample_rate,
+                                unsigned int frame_size, unsigned int tail_ms) {
+  if (sample_rate == 0 || frame_size == 0 || tail_ms == 0)
+    return NULL;
+
+  AudxEchoState *echo = calloc(1, sizeof(AudxEchoState));
+  if (!echo)
+    return NULL;
+
+  echo->frame_size = frame_size;
+  echo->near = calloc(frame_size, sizeof(short));
+  echo->silence = calloc(frame_size, sizeof(short));
+  echo->out = calloc(frame_size, sizeof(short));
+  int filter_length = (int)((unsigned long)tail_ms * sample_rate / 1000);
+  if (echo->near && echo->silence && echo->out)
+    echo->st = speex_echo_state_init((int)frame_size, filter_length);
+  if (!echo->st) {
+    audx_echo_destroy(echo);
+    return NULL;
+  }
+
+  int rate = (int)sample_rate;
+  speex_echo_ctl(echo->st, SPEEX_ECHO_SET_SAMPLING_RATE, &rate);
+  return echo;
+}
+
+void audx_echo_process(AudxEchoState *echo, const float *near,
+                       const short *far, float *out) {
+  pcm_float_to_int16(near, echo->near, (int)echo->frame_size);
+  speex_echo_cancellation(echo->st, echo->near, far ? far : echo->silence,
+                          echo->out);
+  pcm_int16_to_float(echo->out, out, (int)echo->frame_size);
+}
+
+void audx_echo_reset(AudxEchoState *echo) { speex_echo_state_reset(echo->st); }
+
+void audx_echo_destroy(AudxEchoState *echo) {
+  if (!echo)
+    return;
+
+  if (echo->st)
+    speex_echo_state_destroy(echo->st);
+  free(echo->near);
+  free(echo->silence);
+  free(echo->out);
+  free(echo);
+}
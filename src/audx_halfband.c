@@ -0,0 +1,316 @@
+#include "audx_halfband.h"
+#include "audx.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Two stages in a row leak up to 6 dB more than one, so each is designed
+// with margin for the cascade to keep 80 dB.
+#define HB_ATTENUATION_DB 86.0
+// Largest m; a filter has 4m + 3 taps, m + 1 of them distinct and non-zero
+// besides the centre.
+#define HB_MAX_M 64u
+// New samples per polyphase branch handled per internal block
+#define HB_BLOCK 512u
+
+struct AudxHalfband {
+  bool decimate;
+  unsigned int m;
+  unsigned int hist; // 2m + 1 samples of history per branch
+  float *g;          // Folded odd-offset taps, g[j] for offset 2j + 1
+  float *g2;         // 2 * g, the interpolator's taps
+  // Decimator: even/odd input branches sharing one index base.
+  // Interpolator: input history in `even`.
+  float *even;
+  float *odd;
+  unsigned int n_even;
+  unsigned int n_odd;
+  bool next_odd;
+};
+
+/**
+ * out[i] = c * center[i] + sum_j g[j] * (x[i + j] + x[i - 1 - j]), j = 0..m.
+ *
+ * Sixteen outputs are computed per pass with four independent accumulators
+ * held in registers across all taps, which hides the add latency and costs
+ * two loads and a multiply-add per tap pair and vector.
+ */
+static inline void hb_fir(float *out, const float *center, float c,
+                          const float *x, const float *g, unsigned int m,
+                          unsigned int count) {
+  unsigned int i = 0;
+#ifdef HAS_X86_SIMD
+  const __m128 vc = _mm_set1_ps(c);
+  for (; i + 16 <= count; i += 16) {
+    __m128 a0 = _mm_mul_ps(_mm_loadu_ps(&center[i]), vc);
+    __m128 a1 = _mm_mul_ps(_mm_loadu_ps(&center[i + 4]), vc);
+    __m128 a2 = _mm_mul_ps(_mm_loadu_ps(&center[i + 8]), vc);
+    __m128 a3 = _mm_mul_ps(_mm_loadu_ps(&center[i + 12]), vc);
+    for (unsigned int j = 0; j <= m; j++) {
+      const float *hi = x + i + j;
+      const float *lo = x + i - 1 - j;
+      const __m128 vg = _mm_set1_ps(g[j]);
+      a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(hi),
+                                                _mm_loadu_ps(lo)),
+                                     vg));
+      a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(hi + 4),
+                                                _mm_loadu_ps(lo + 4)),
+                                     vg));
+      a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(hi + 8),
+                                                _mm_loadu_ps(lo + 8)),
+                                     vg));
+      a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(hi + 12),
+                                                _mm_loadu_ps(lo + 12)),
+                                     vg));
+    }
+    _mm_storeu_ps(&out[i], a0);
+    _mm_storeu_ps(&out[i + 4], a1);
+    _mm_storeu_ps(&out[i + 8], a2);
+    _mm_storeu_ps(&out[i + 12], a3);
+  }
+#elif defined(HAS_ARM_NEON)
+  for (; i + 16 <= count; i += 16) {
+    float32x4_t a0 = vmulq_n_f32(vld1q_f32(&center[i]), c);
+    float32x4_t a1 = vmulq_n_f32(vld1q_f32(&center[i + 4]), c);
+    float32x4_t a2 = vmulq_n_f32(vld1q_f32(&center[i + 8]), c);
+    float32x4_t a3 = vmulq_n_f32(vld1q_f32(&center[i + 12]), c);
+    for (unsigned int j = 0; j <= m; j++) {
+      const float *hi = x + i + j;
+      const float *lo = x + i - 1 - j;
+      a0 = vmlaq_n_f32(a0, vaddq_f32(vld1q_f32(hi), vld1q_f32(lo)), g[j]);
+      a1 = vmlaq_n_f32(a1, vaddq_f32(vld1q_f32(hi + 4), vld1q_f32(lo + 4)),
+                       g[j]);
+      a2 = vmlaq_n_f32(a2, vaddq_f32(vld1q_f32(hi + 8), vld1q_f32(lo + 8)),
+                       g[j]);
+      a3 = vmlaq_n_f32(a3, vaddq_f32(vld1q_f32(hi + 12), vld1q_f32(lo + 12)),
+                       g[j]);
+    }
+    vst1q_f32(&out[i], a0);
+    vst1q_f32(&out[i + 4], a1);
+    vst1q_f32(&out[i + 8], a2);
+    vst1q_f32(&out[i + 12], a3);
+  }
+#endif
+  for (; i < count; i++) {
+    float acc = c * center[i];
+    for (unsigned int j = 0; j <= m; j++) {
+      const float *hi = x + i + j;
+      const float *lo = x + i - 1 - j;
+      acc += g[j] * (*hi + *lo);
+    }
+    out[i] = acc;
+  }
+}
+
+static double bessel_i0(double x) {
+  double sum = 1.0, term = 1.0;
+  for (int k = 1; k < 50; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+/**
+ * Kaiser-windowed half-band design. Taps are scaled so the folded pairs sum
+ * to 0.5, which together with the exact 0.5 centre gives unity DC gain and
+ * keeps the odd interpolator phase a pure delay.
+ */
+static void design(AudxHalfband *hb, double transition) {
+  double beta = 0.1102 * (HB_ATTENUATION_DB - 8.7);
+  double taps =
+      (HB_ATTENUATION_DB - 8.0) / (2.285 * 2.0 * M_PI * transition) + 1.0;
+  unsigned int m = taps > 3.0 ? (unsigned int)ceil((taps - 3.0) / 4.0) : 0;
+  if (m > HB_MAX_M)
+    m = HB_MAX_M;
+
+  unsigned int n = 4 * m + 3;
+  unsigned int c = 2 * m + 1;
+  double sum = 0.0;
+  for (unsigned int j = 0; j <= m; j++) {
+    unsigned int k = 2 * j + 1;
+    double r = 2.0 * (double)(c + k) / (double)(n - 1) - 1.0;
+    double window = bessel_i0(beta * sqrt(1.0 - r * r)) / bessel_i0(beta);
+    double h = sin(M_PI * k / 2.0) / (M_PI * k) * window;
+    hb->g[j] = (float)h;
+    sum += h;
+  }
+  for (unsigned int j = 0; j <= m; j++) {
+    hb->g[j] = (float)(hb->g[j] * 0.25 / sum);
+    hb->g2[j] = 2.0f * hb->g[j];
+  }
+
+  hb->m = m;
+  hb->hist = 2 * m + 1;
+}
+
+AudxHalfband *audx_halfband_create(bool decimate, double transition) {
+  if (!(transition > 0.0 && transition < 0.5))
+    return NULL;
+
+  AudxHalfband *hb = calloc(1, sizeof(AudxHalfband));
+  if (!hb)
+    return NULL;
+
+  hb->decimate = decimate;
+  hb->g = malloc(sizeof(float) * (HB_MAX_M + 1));
+  hb->g2 = malloc(sizeof(float) * (HB_MAX_M + 1));
+  if (!hb->g || !hb->g2) {
+    audx_halfband_destroy(hb);
+    return NULL;
+  }
+  design(hb, transition);
+
+  // One spare slot: an odd-length block may leave an extra odd sample.
+  size_t len = hb->hist + HB_BLOCK + 1;
+  hb->even = malloc(sizeof(float) * len);
+  hb->odd = decimate ? malloc(sizeof(float) * len) : NULL;
+  if (!hb->even || (decimate && !hb->odd)) {
+    audx_halfband_destroy(hb);
+    return NULL;
+  }
+
+  audx_halfband_reset(hb);
+  return hb;
+}
+
+void audx_halfband_reset(AudxHalfband *hb) {
+  if (!hb)
+    return;
+
+  memset(hb->even, 0, sizeof(float) * hb->hist);
+  if (hb->odd)
+    memset(hb->odd, 0, sizeof(float) * hb->hist);
+  hb->n_even = hb->hist;
+  hb->n_odd = hb->hist;
+  hb->next_odd = false;
+}
+
+unsigned int audx_halfband_delay(const AudxHalfband *hb) {
+  return hb ? 2 * hb->m + 1 : 0;
+}
+
+/*
+ * With c = 2m + 1 the decimator output for even branch index q is
+ *
+ *   y[q] = 0.5 * xo[q - m - 1]
+ *        + sum_j g[j] * (xe[q - m + j] + xe[q - m - 1 - j])
+ *
+ * so every output of a block is a sum of contiguous, shifted branch slices.
+ */
+static unsigned int decimate_block(AudxHalfband *hb, const float *in,
+                                   unsigned int count, float *out) {
+  // Split into branches with local cursors; going through hb-> would make
+  // every store a possible alias of the counters.
+  float *even_end = hb->even + hb->n_even;
+  float *odd_end = hb->odd + hb->n_odd;
+  unsigned int i = 0;
+  if (hb->next_odd && count > 0)
+    *odd_end++ = in[i++];
+#ifdef HAS_X86_SIMD
+  for (; i + 8 <= count; i += 8) {
+    __m128 lo = _mm_loadu_ps(&in[i]);
+    __m128 hi = _mm_loadu_ps(&in[i + 4]);
+    _mm_storeu_ps(even_end, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(odd_end, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    even_end += 4;
+    odd_end += 4;
+  }
+#elif defined(HAS_ARM_NEON)
+  for (; i + 8 <= count; i += 8) {
+    float32x4x2_t pair = vld2q_f32(&in[i]);
+    vst1q_f32(even_end, pair.val[0]);
+    vst1q_f32(odd_end, pair.val[1]);
+    even_end += 4;
+    odd_end += 4;
+  }
+#endif
+  for (; i + 2 <= count; i += 2) {
+    *even_end++ = in[i];
+    *odd_end++ = in[i + 1];
+  }
+  if (i < count) {
+    *even_end++ = in[i];
+    hb->next_odd = true;
+  } else if (count > 0) {
+    hb->next_odd = false;
+  }
+  hb->n_even = (unsigned int)(even_end - hb->even);
+  hb->n_odd = (unsigned int)(odd_end - hb->odd);
+
+  unsigned int m = hb->m;
+  unsigned int produced = hb->n_even - hb->hist;
+  hb_fir(out, hb->odd + hb->hist - m - 1, 0.5f, hb->even + hb->hist - m,
+         hb->g, m, produced);
+
+  memmove(hb->even, hb->even + produced, sizeof(float) * hb->hist);
+  memmove(hb->odd, hb->odd + produced,
+          sizeof(float) * (hb->n_odd - produced));
+  hb->n_even = hb->hist;
+  hb->n_odd -= produced;
+  return produced;
+}
+
+/*
+ * Zero-stuffed input through 2h gives, for input index q,
+ *
+ *   y[2q]     = 2 * sum_j g[j] * (x[q - m + j] + x[q - m - 1 - j])
+ *   y[2q + 1] = x[q - m]
+ */
+static unsigned int interpolate_block(AudxHalfband *hb, const float *in,
+                                      unsigned int count, float *out,
+                                      float *acc) {
+  unsigned int m = hb->m;
+  memcpy(hb->even + hb->hist, in, sizeof(float) * count);
+
+  // The interpolator taps (2h) are kept pre-doubled in g2.
+  const float *x = hb->even + hb->hist - m;
+  hb_fir(acc, x, 0.0f, x, hb->g2, m, count);
+
+  for (unsigned int k = 0; k < count; k++) {
+    out[2 * k] = acc[k];
+    out[2 * k + 1] = x[k];
+  }
+
+  memmove(hb->even, hb->even + count, sizeof(float) * hb->hist);
+  return 2 * count;
+}
+
+unsigned int audx_halfband_process(AudxHalfband *hb, const float *in,
+                                   unsigned int count, float *out) {
+  if (!hb || !in || !out)
+    return 0;
+
+  unsigned int written = 0;
+  if (hb->decimate) {
+    // 2 * HB_BLOCK inputs add at most HB_BLOCK samples to each branch.
+    while (count > 0) {
+      unsigned int n = count < 2 * HB_BLOCK ? count : 2 * HB_BLOCK;
+      written += decimate_block(hb, in, n, out + written);
+      in += n;
+      count -= n;
+    }
+  } else {
+    float acc[HB_BLOCK];
+    while (count > 0) {
+      unsigned int n = count < HB_BLOCK ? count : HB_BLOCK;
+      written += interpolate_block(hb, in, n, out + written, acc);
+      in += n;
+      count -= n;
+    }
+  }
+  return written;
+}
+
+void audx_halfband_destroy(AudxHalfband *hb) {
+  if (!hb)
+    return;
+
+  free(hb->g);
+  free(hb->g2);
+  free(hb->even);
+  free(hb->odd);
+  free(hb);
+}
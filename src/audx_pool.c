@@ -0,0 +1,256 @@
+#define AUDX_RT_INTERNAL
+#include "audx_pool.h"
+#include "audx_rt.h"
+#include "audx_time.h"
+#define AUDX_TRACE_INTERNAL
+#include "audx_trace.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct AudxPool {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  AudxJob *head;
+  AudxJob *tail;
+  size_t queued;
+  unsigned int idle;
+  bool stopping;
+  unsigned int count;
+  pthread_t threads[];
+};
+
+static void run_job(AudxJob *job) {
+  // Worker calls carry no state, only their callback.
+  if (!job->state) {
+    job->done(job);
+    return;
+  }
+
+  if (job->format == AUDX_JOB_S16)
+    job->vad_prob =
+        audx_process_int(job->state, (short *)job->in, (short *)job->out);
+  else
+    job->vad_prob =
+        audx_process(job->state, (float *)job->in, (float *)job->out);
+
+  if (job->done)
+    job->done(job);
+}
+
+static void *pool_main(void *arg) {
+  AudxPool *pool = arg;
+
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->head && !pool->stopping) {
+      pool->idle++;
+      pthread_cond_wait(&pool->cond, &pool->lock);
+      pool->idle--;
+    }
+
+    AudxJob *batch = pool->head;
+    if (!batch) {
+      pthread_mutex_unlock(&pool->lock);
+      return NULL;
+    }
+
+    // Take a fair share of the queue, so a burst spreads over idle workers
+    // while a deep queue is still drained with few lock round trips. Worker
+    // calls are taken one at a time, so that each goes to a different worker.
+    size_t take = pool->queued / pool->count;
+    if (take < 1 || !batch->state)
+      take = 1;
+    if (take > AUDX_POOL_MAX_BATCH)
+      take = AUDX_POOL_MAX_BATCH;
+
+    AudxJob *last = batch;
+    size_t taken = 1;
+    for (; taken < take && last->next && last->next->state; taken++)
+      last = last->next;
+    pool->head = last->next;
+    if (!pool->head)
+      pool->tail = NULL;
+    last->next = NULL;
+    pool->queued -= taken;
+
+    bool wake = pool->head && pool->idle > 0;
+    pthread_mutex_unlock(&pool->lock);
+    if (wake)
+      pthread_cond_signal(&pool->cond);
+
+    bool tracing =
+        atomic_load_explicit(&audx_trace_active, memory_order_relaxed);
+    uint64_t t0 = tracing ? audx_now_ns() : 0;
+    size_t jobs = 0;
+    while (batch) {
+      // done() may resubmit or free the job, so read the link first.
+      AudxJob *next = batch->next;
+      if (tracing && batch->submit_ns)
+        audx_trace_record(AUDX_TRACE_POOL_WAIT, batch->submit_ns, t0,
+                          batch->state, 0);
+      run_job(batch);
+      batch = next;
+      jobs++;
+    }
+    if (tracing)
+      audx_trace_record(AUDX_TRACE_POOL_BATCH, t0, audx_now_ns(), pool, jobs);
+  }
+}
+
+AudxPool *audx_pool_create(unsigned int threads) {
+  if (threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cpus > 0 ? (unsigned int)cpus : 1;
+  }
+
+  AudxPool *pool = calloc(1, sizeof(AudxPool) + threads * sizeof(pthread_t));
+  if (!pool)
+    return NULL;
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->cond, NULL);
+
+  for (; pool->count < threads; pool->count++) {
+    if (pthread_create(&pool->threads[pool->count], NULL, pool_main, pool) !=
+        0)
+      break;
+  }
+
+  if (pool->count == 0) {
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+    return NULL;
+  }
+
+  return pool;
+}
+
+int audx_pool_submit(AudxPool *pool, AudxJob *job) {
+  if (!pool || !job || !job->state || !job->in || !job->out)
+    return -1;
+
+  job->next = NULL;
+  job->submit_ns =
+      atomic_load_explicit(&audx_trace_active, memory_order_relaxed)
+          ? audx_now_ns()
+          : 0;
+  pthread_mutex_lock(&pool->lock);
+  if (pool->stopping) {
+    pthread_mutex_unlock(&pool->lock);
+    return -1;
+  }
+
+  if (pool->tail)
+    pool->tail->next = job;
+  else
+    pool->head = job;
+  pool->tail = job;
+  pool->queued++;
+
+  bool wake = pool->idle > 0;
+  pthread_mutex_unlock(&pool->lock);
+  if (wake)
+    pthread_cond_signal(&pool->cond);
+  return 0;
+}
+
+void audx_pool_destroy(AudxPool *pool) {
+  if (!pool)
+    return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_mutex_unlock(&pool->lock);
+  pthread_cond_broadcast(&pool->cond);
+
+  for (unsigned int i = 0; i < pool->count; i++)
+    pthread_join(pool->threads[i], NULL);
+
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool);
+}
+
+typedef struct WorkerCall {
+  int (*fn)(void *arg);
+  void *arg;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  unsigned int count;
+  unsigned int arrived;
+  unsigned int left;
+  bool failed;
+} WorkerCall;
+
+// Holds the worker until every worker has made its call, so that none can
+// take a second one.
+static void worker_call_done(AudxJob *job) {
+  WorkerCall *call = job->user_data;
+  int ret = call->fn(call->arg);
+
+  pthread_mutex_lock(&call->lock);
+  if (ret != 0)
+    call->failed = true;
+  call->arrived++;
+  pthread_cond_broadcast(&call->cond);
+  while (call->arrived < call->count)
+    pthread_cond_wait(&call->cond, &call->lock);
+  call->left++;
+  pthread_cond_broadcast(&call->cond);
+  pthread_mutex_unlock(&call->lock);
+}
+
+int audx_pool_run_on_workers(AudxPool *pool, int (*fn)(void *arg),
+                             void *arg) {
+  if (!pool || !fn)
+    return -1;
+
+  AudxJob *jobs = calloc(pool->count, sizeof(AudxJob));
+  if (!jobs)
+    return -1;
+
+  WorkerCall call = {.fn = fn, .arg = arg, .count = pool->count};
+  pthread_mutex_init(&call.lock, NULL);
+  pthread_cond_init(&call.cond, NULL);
+  for (unsigned int i = 0; i < pool->count; i++) {
+    jobs[i].done = worker_call_done;
+    jobs[i].user_data = &call;
+    jobs[i].next = i + 1 < pool->count ? &jobs[i + 1] : NULL;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  bool stopping = pool->stopping;
+  if (!stopping) {
+    if (pool->tail)
+      pool->tail->next = jobs;
+    else
+      pool->head = jobs;
+    pool->tail = &jobs[pool->count - 1];
+    pool->queued += pool->count;
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  if (!stopping) {
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_lock(&call.lock);
+    while (call.left < call.count)
+      pthread_cond_wait(&call.cond, &call.lock);
+    pthread_mutex_unlock(&call.lock);
+  }
+
+  pthread_cond_destroy(&call.cond);
+  pthread_mutex_destroy(&call.lock);
+  free(jobs);
+  return stopping || call.failed ? -1 : 0;
+}
+
+unsigned int audx_pool_thread_count(const AudxPool *pool) {
+  return pool ? pool->count : 0;
+}
+
+pthread_t audx_pool_thread(const AudxPool *pool, unsigned int index) {
+  return pool->threads[index];
+}
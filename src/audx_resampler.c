@@ -1,27 +1,229 @@
 #include "audx_resampler.h"
+#include "audx_halfband.h"
 #include "speex/speex_resampler.h"
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Half-band stages are used when the high side of the conversion is above
+// this rate; below it the single fractional stage is already cheap.
+#define HALFBAND_MIN_RATE 48000u
+#define HALFBAND_MAX_STAGES 3u
+// Passband edge of the cascade, relative to the rate at its low end
+#define HALFBAND_PASSBAND 0.4
+// Lowest intermediate rate, relative to the low end, that the stages may
+// reach; 88.2 kHz goes through 44.1 kHz on its way to 48 kHz.
+#define HALFBAND_MIN_INTERMEDIATE 0.9
+// Lowest quality of a fractional stage at such an intermediate rate. The
+// passband reaches within 3 kHz of its Nyquist, which lower qualities roll
+// off by up to several dB.
+#define HALFBAND_MIN_FRAC_QUALITY 6
+// Samples at the high rate pushed through the cascade per internal step
+#define RESAMPLER_CHUNK 2048u
 
 struct AudxResamplerState {
+  // Fractional stage; NULL when the half-band stages cover the whole ratio
+  // and no drift correction has been requested.
   SpeexResamplerState *st;
+  unsigned int spx_in_rate;
+  unsigned int spx_out_rate;
+  int quality;
+
+  // Power-of-two part of the ratio: in -> stages -> st -> out when
+  // decimating, in -> st -> stages -> out when interpolating.
+  AudxHalfband *stages[HALFBAND_MAX_STAGES];
+  unsigned int n_stages;
+  bool decimate;
+
+  float *scratch[2];
+  // Decimation output waiting for room in the fractional stage's output
+  float *pending;
+  unsigned int n_pending;
 };
 
+static unsigned int halfband_stage_count(unsigned int in_rate,
+                                         unsigned int out_rate) {
+  unsigned int high = in_rate > out_rate ? in_rate : out_rate;
+  unsigned int low = in_rate > out_rate ? out_rate : in_rate;
+  if (high <= HALFBAND_MIN_RATE)
+    return 0;
+
+  unsigned int k = 0;
+  while (k < HALFBAND_MAX_STAGES && (high >> k) % 2 == 0 &&
+         (double)(high >> (k + 1)) >= HALFBAND_MIN_INTERMEDIATE * low)
+    k++;
+  return k;
+}
+
+static int create_stages(AudxResamplerState *st, unsigned int in_rate,
+                         unsigned int out_rate, unsigned int k) {
+  unsigned int high = st->decimate ? in_rate : out_rate;
+  unsigned int low = st->decimate ? out_rate : in_rate;
+  double passband = HALFBAND_PASSBAND * (double)low;
+
+  for (unsigned int i = 0; i < k; i++) {
+    // A stage at `rate` keeps [0, passband] and must reject everything that
+    // folds onto it around rate / 4, so its stopband starts at rate / 2 minus
+    // the passband. Decimation runs the fastest stage first, interpolation
+    // last.
+    unsigned int rate = high >> (st->decimate ? i : k - 1 - i);
+    double transition = ((double)rate / 2.0 - 2.0 * passband) / (double)rate;
+    st->stages[i] = audx_halfband_create(st->decimate, transition);
+    if (!st->stages[i])
+      return -1;
+    st->n_stages++;
+  }
+
+  for (int i = 0; i < 2; i++) {
+    st->scratch[i] = malloc(sizeof(float) * RESAMPLER_CHUNK);
+    if (!st->scratch[i])
+      return -1;
+  }
+  if (st->decimate) {
+    st->pending = malloc(sizeof(float) * RESAMPLER_CHUNK);
+    if (!st->pending)
+      return -1;
+  }
+  return 0;
+}
+
 AudxResamplerState *audx_resampler_create(unsigned int in_rate,
                                           unsigned int out_rate, int quality) {
-  AudxResamplerState *st = malloc(sizeof(AudxResamplerState));
+  if (in_rate == 0 || out_rate == 0) {
+    return NULL;
+  }
+
+  AudxResamplerState *st = calloc(1, sizeof(AudxResamplerState));
   if (!st) {
     return NULL;
   }
 
-  int err = 0;
-  st->st = speex_resampler_init(1, in_rate, out_rate, quality, &err);
-  if (err != 0) {
-    free(st);
+  st->quality = quality;
+  st->decimate = in_rate > out_rate;
+  unsigned int k = halfband_stage_count(in_rate, out_rate);
+  st->spx_in_rate = st->decimate ? in_rate >> k : in_rate;
+  st->spx_out_rate = st->decimate ? out_rate : out_rate >> k;
+  unsigned int low = in_rate < out_rate ? in_rate : out_rate;
+  if ((st->spx_in_rate < low || st->spx_out_rate < low) &&
+      st->quality < HALFBAND_MIN_FRAC_QUALITY)
+    st->quality = HALFBAND_MIN_FRAC_QUALITY;
+
+  if (k > 0 && create_stages(st, in_rate, out_rate, k) != 0) {
+    audx_resampler_destroy(st);
     return NULL;
   }
+
+  if (st->spx_in_rate != st->spx_out_rate) {
+    int err = 0;
+    st->st = speex_resampler_init(1, st->spx_in_rate, st->spx_out_rate,
+                                  st->quality, &err);
+    if (err != 0) {
+      audx_resampler_destroy(st);
+      return NULL;
+    }
+  }
   return st;
 }
 
+// Run a block through the half-band cascade, ending in `out`.
+static unsigned int run_stages(AudxResamplerState *st, const float *in,
+                               unsigned int count, float *out) {
+  for (unsigned int i = 0; i < st->n_stages; i++) {
+    float *dst = i + 1 == st->n_stages ? out : st->scratch[i % 2];
+    count = audx_halfband_process(st->stages[i], in, count, dst);
+    in = dst;
+  }
+  return count;
+}
+
+static int process_decimate(AudxResamplerState *st, const float *in,
+                            unsigned int *in_len, float *out,
+                            unsigned int *out_len) {
+  unsigned int k = st->n_stages;
+  unsigned int consumed = 0;
+  unsigned int produced = 0;
+
+  for (;;) {
+    if (st->st && st->n_pending > 0) {
+      unsigned int spx_in = st->n_pending;
+      unsigned int spx_out = *out_len - produced;
+      if (speex_resampler_process_float(st->st, 0, st->pending, &spx_in,
+                                        out + produced, &spx_out) != 0)
+        return -1;
+      produced += spx_out;
+      st->n_pending -= spx_in;
+      memmove(st->pending, st->pending + spx_in,
+              sizeof(float) * st->n_pending);
+      // Output is full; leave the rest of the input to the next call.
+      if (st->n_pending > 0)
+        break;
+    }
+
+    unsigned int n = *in_len - consumed;
+    if (n > RESAMPLER_CHUNK)
+      n = RESAMPLER_CHUNK;
+    if (!st->st) {
+      // Each stage writes at most ceil(count / 2), so this always fits.
+      unsigned int room = (*out_len - produced) << k;
+      if (n > room)
+        n = room;
+    }
+    if (n == 0)
+      break;
+
+    float *dst = st->st ? st->pending : out + produced;
+    unsigned int count = run_stages(st, in + consumed, n, dst);
+    consumed += n;
+    if (st->st)
+      st->n_pending = count;
+    else
+      produced += count;
+  }
+
+  *in_len = consumed;
+  *out_len = produced;
+  return 0;
+}
+
+static int process_interpolate(AudxResamplerState *st, const float *in,
+                               unsigned int *in_len, float *out,
+                               unsigned int *out_len) {
+  unsigned int k = st->n_stages;
+  unsigned int consumed = 0;
+  unsigned int produced = 0;
+
+  for (;;) {
+    unsigned int room = (*out_len - produced) >> k;
+    if (room > RESAMPLER_CHUNK >> k)
+      room = RESAMPLER_CHUNK >> k;
+
+    const float *src = in + consumed;
+    unsigned int count = *in_len - consumed;
+    if (st->st) {
+      unsigned int spx_in = count;
+      count = room;
+      // The first stage writes scratch[0], leaving scratch[1] for its input.
+      if (speex_resampler_process_float(st->st, 0, src, &spx_in,
+                                        st->scratch[1], &count) != 0)
+        return -1;
+      src = st->scratch[1];
+      consumed += spx_in;
+    } else {
+      if (count > room)
+        count = room;
+      consumed += count;
+    }
+    if (count == 0)
+      break;
+
+    produced += run_stages(st, src, count, out + produced);
+  }
+
+  *in_len = consumed;
+  *out_len = produced;
+  return 0;
+}
+
 int audx_resampler_process(AudxResamplerState *st, const float *in,
                            unsigned int *in_len, float *out,
                            unsigned int *out_len) {
@@ -29,7 +231,69 @@ int audx_resampler_process(AudxResamplerState *st, const float *in,
     return -1;
   }
 
-  int ret = speex_resampler_process_float(st->st, 0, in, in_len, out, out_len);
+  if (st->n_stages == 0) {
+    if (!st->st) {
+      // Equal rates and no drift correction yet: pass the input through.
+      unsigned int n = *in_len < *out_len ? *in_len : *out_len;
+      if (out != in)
+        memmove(out, in, sizeof(float) * n);
+      *in_len = n;
+      *out_len = n;
+      return 0;
+    }
+    if (speex_resampler_process_float(st->st, 0, in, in_len, out, out_len) !=
+        0) {
+      return -1;
+    }
+    return 0;
+  }
+
+  if (st->decimate) {
+    return process_decimate(st, in, in_len, out, out_len);
+  }
+  return process_interpolate(st, in, in_len, out, out_len);
+}
+
+int audx_resampler_set_rate_frac(AudxResamplerState *st,
+                                 unsigned int ratio_num,
+                                 unsigned int ratio_den, unsigned int in_rate,
+                                 unsigned int out_rate) {
+  if (!st || ratio_num == 0 || ratio_den == 0) {
+    return -1;
+  }
+
+  // The half-band stages take a fixed factor of 2^k out of the ratio; the
+  // fractional stage carries the rest, including any drift correction.
+  unsigned int k = st->n_stages;
+  uint64_t num = ratio_num;
+  uint64_t den = ratio_den;
+  if (st->decimate) {
+    den <<= k;
+    in_rate >>= k;
+  } else {
+    num <<= k;
+    out_rate >>= k;
+  }
+  while (num > UINT32_MAX || den > UINT32_MAX) {
+    num >>= 1;
+    den >>= 1;
+  }
+  if (num == 0 || den == 0) {
+    return -1;
+  }
+
+  if (!st->st) {
+    int err = 0;
+    st->st = speex_resampler_init(1, st->spx_in_rate, st->spx_out_rate,
+                                  st->quality, &err);
+    if (err != 0) {
+      st->st = NULL;
+      return -1;
+    }
+  }
+
+  int ret = speex_resampler_set_rate_frac(st->st, (unsigned int)num,
+                                          (unsigned int)den, in_rate, out_rate);
   if (ret != 0) {
     return -1;
   }
@@ -37,11 +301,59 @@ int audx_resampler_process(AudxResamplerState *st, const float *in,
   return 0;
 }
 
+int audx_resampler_reset(AudxResamplerState *st) {
+  if (!st) {
+    return -1;
+  }
+
+  for (unsigned int i = 0; i < st->n_stages; i++) {
+    audx_halfband_reset(st->stages[i]);
+  }
+  st->n_pending = 0;
+
+  if (st->st && speex_resampler_reset_mem(st->st) != 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+double audx_resampler_delay(const AudxResamplerState *st) {
+  if (!st) {
+    return 0.0;
+  }
+
+  // Sum each stage's delay in seconds at the rate it runs at.
+  unsigned int k = st->n_stages;
+  double seconds = 0.0;
+  if (st->st) {
+    seconds += (double)speex_resampler_get_input_latency(st->st) /
+               (double)st->spx_in_rate;
+  }
+  for (unsigned int i = 0; i < k; i++) {
+    unsigned int rate = st->decimate ? st->spx_in_rate << (k - i)
+                                     : st->spx_out_rate << (i + 1);
+    seconds += (double)audx_halfband_delay(st->stages[i]) / (double)rate;
+  }
+
+  unsigned int out_rate =
+      st->decimate ? st->spx_out_rate : st->spx_out_rate << k;
+  return seconds * (double)out_rate;
+}
+
 void audx_resampler_destroy(AudxResamplerState *st) {
   if (!st) {
     return;
   }
 
-  speex_resampler_destroy(st->st);
+  if (st->st) {
+    speex_resampler_destroy(st->st);
+  }
+  for (unsigned int i = 0; i < st->n_stages; i++) {
+    audx_halfband_destroy(st->stages[i]);
+  }
+  free(st->scratch[0]);
+  free(st->scratch[1]);
+  free(st->pending);
   free(st);
 }
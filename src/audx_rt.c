@@ -0,0 +1,199 @@
+#define _GNU_SOURCE
+#define AUDX_RT_INTERNAL
+#include "audx_rt.h"
+#include <link.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define RT_DEFAULT_PRIORITY 10
+#define RT_DEFAULT_PREFAULT_STACK (256u * 1024u)
+#define RT_PAGE_SIZE 4096u
+
+void audx_rt_default_options(AudxRtOptions *opts) {
+  if (!opts)
+    return;
+
+  opts->cpu = -1;
+  opts->policy = AUDX_RT_POLICY_FIFO;
+  opts->priority = RT_DEFAULT_PRIORITY;
+  opts->lock_memory = true;
+  opts->lock_all = false;
+  opts->prefault_stack = RT_DEFAULT_PREFAULT_STACK;
+}
+
+static int set_affinity(pthread_t thread, int cpu) {
+#if defined(__linux__)
+  long cpus = sysconf(_SC_NPROCESSORS_CONF);
+  if (cpus <= 0)
+    return -1;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % cpus, &set);
+  return pthread_setaffinity_np(thread, sizeof(set), &set) == 0 ? 0 : -1;
+#else
+  (void)thread;
+  (void)cpu;
+  return -1;
+#endif
+}
+
+static int set_scheduling(pthread_t thread, AudxRtPolicy policy,
+                          int priority) {
+  int sched_policy = policy == AUDX_RT_POLICY_RR ? SCHED_RR : SCHED_FIFO;
+  int min = sched_get_priority_min(sched_policy);
+  int max = sched_get_priority_max(sched_policy);
+  if (priority < min)
+    priority = min;
+  if (priority > max)
+    priority = max;
+
+  struct sched_param param = {.sched_priority = priority};
+  return pthread_setschedparam(thread, sched_policy, &param) == 0 ? 0 : -1;
+}
+
+/**
+ * Touch the requested amount of stack below this frame, capped at half the
+ * thread's stack so a large request cannot overflow it.
+ */
+static __attribute__((noinline)) int prefault_stack(size_t bytes) {
+  pthread_attr_t attr;
+  size_t stack_size = 0;
+  if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+    pthread_attr_getstacksize(&attr, &stack_size);
+    pthread_attr_destroy(&attr);
+  }
+  if (stack_size == 0)
+    return -1;
+  if (bytes > stack_size / 2)
+    bytes = stack_size / 2;
+
+  unsigned char buf[bytes];
+  volatile unsigned char *touch = buf;
+  for (size_t i = 0; i < bytes; i += RT_PAGE_SIZE)
+    touch[i] = 0;
+  return 0;
+}
+
+static int prefault_worker_stack(void *arg) {
+  return prefault_stack(*(const size_t *)arg);
+}
+
+typedef struct SegmentLock {
+  uintptr_t self;
+  int result;
+} SegmentLock;
+
+// Lock every loadable segment of the object containing this file. rnnoise and
+// speexdsp are linked in statically, so that covers their code, tables and
+// the built-in model weights.
+static int lock_object_segments(struct dl_phdr_info *info, size_t size,
+                                void *arg) {
+  (void)size;
+  SegmentLock *lock = arg;
+
+  bool owner = false;
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr) *ph = &info->dlpi_phdr[i];
+    uintptr_t start = info->dlpi_addr + ph->p_vaddr;
+    if (ph->p_type == PT_LOAD && lock->self >= start &&
+        lock->self < start + ph->p_memsz)
+      owner = true;
+  }
+  if (!owner)
+    return 0;
+
+  lock->result = 0;
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr) *ph = &info->dlpi_phdr[i];
+    if (ph->p_type != PT_LOAD)
+      continue;
+    if (mlock((const void *)(info->dlpi_addr + ph->p_vaddr), ph->p_memsz) != 0)
+      lock->result = -1;
+  }
+  return 1;
+}
+
+static int lock_library(void) {
+  SegmentLock lock = {(uintptr_t)&lock_library, -1};
+  dl_iterate_phdr(lock_object_segments, &lock);
+  return lock.result;
+}
+
+// Steps shared by every entry point, independent of the target threads.
+static int prepare_memory(const AudxRtOptions *opts) {
+  int failed = 0;
+  if (opts->lock_memory && lock_library() != 0)
+    failed |= AUDX_RT_FAILED_MLOCK;
+  if (opts->lock_all && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    failed |= AUDX_RT_FAILED_MLOCKALL;
+  return failed;
+}
+
+int audx_rt_prepare_thread(const AudxRtOptions *opts) {
+  AudxRtOptions defaults;
+  if (!opts) {
+    audx_rt_default_options(&defaults);
+    opts = &defaults;
+  }
+
+  int failed = 0;
+  if (opts->cpu >= 0 && set_affinity(pthread_self(), opts->cpu) != 0)
+    failed |= AUDX_RT_FAILED_AFFINITY;
+  if (opts->policy != AUDX_RT_POLICY_NONE &&
+      set_scheduling(pthread_self(), opts->policy, opts->priority) != 0)
+    failed |= AUDX_RT_FAILED_SCHED;
+
+  failed |= prepare_memory(opts);
+
+  // After mlockall(MCL_FUTURE) the touched stack pages stay resident.
+  if (opts->prefault_stack && prefault_stack(opts->prefault_stack) != 0)
+    failed |= AUDX_RT_FAILED_PREFAULT;
+  return failed;
+}
+
+int audx_rt_prepare_state(AudxState *state, const AudxRtOptions *opts) {
+  AudxRtOptions defaults;
+  if (!opts) {
+    audx_rt_default_options(&defaults);
+    opts = &defaults;
+  }
+
+  int failed = audx_rt_prepare_thread(opts);
+  if (state && opts->lock_memory && audx_state_lock_memory(state) != 0)
+    failed |= AUDX_RT_FAILED_MLOCK;
+  return failed;
+}
+
+int audx_rt_prepare_pool(AudxPool *pool, const AudxRtOptions *opts) {
+  AudxRtOptions defaults;
+  if (!opts) {
+    audx_rt_default_options(&defaults);
+    opts = &defaults;
+  }
+  if (!pool)
+    return AUDX_RT_FAILED_AFFINITY | AUDX_RT_FAILED_SCHED;
+
+  int failed = 0;
+  unsigned int count = audx_pool_thread_count(pool);
+  for (unsigned int i = 0; i < count; i++) {
+    pthread_t thread = audx_pool_thread(pool, i);
+    if (opts->cpu >= 0 && set_affinity(thread, opts->cpu + (int)i) != 0)
+      failed |= AUDX_RT_FAILED_AFFINITY;
+    if (opts->policy != AUDX_RT_POLICY_NONE &&
+        set_scheduling(thread, opts->policy, opts->priority) != 0)
+      failed |= AUDX_RT_FAILED_SCHED;
+  }
+
+  failed |= prepare_memory(opts);
+
+  // Each worker touches its own stack, after mlockall as for a thread.
+  size_t bytes = opts->prefault_stack;
+  if (bytes &&
+      audx_pool_run_on_workers(pool, prefault_worker_stack, &bytes) != 0)
+    failed |= AUDX_RT_FAILED_PREFAULT;
+  return failed;
+}
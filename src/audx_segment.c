@@ -0,0 +1,186 @@
+#include "audx_segment.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct AudxSegmenter {
+  float start_threshold;
+  float stop_threshold;
+  unsigned int hangover_frames;
+  unsigned int preroll;     // Samples
+  unsigned int max_segment; // Samples
+  unsigned int frame_len;
+  size_t sample_size;
+
+  // The ring holds the last `capacity` samples pushed: enough for the
+  // pre-roll plus the frame that opens a segment.
+  unsigned char *ring;
+  unsigned int capacity;
+  uint64_t written; // Samples pushed
+  uint64_t emitted; // End of the audio released so far
+
+  bool active;
+  uint64_t segment_start;
+  unsigned int silence_frames; // Consecutive frames below stop_threshold
+};
+
+static unsigned int ms_to_samples(unsigned int ms, unsigned int rate) {
+  return (unsigned int)((uint64_t)ms * rate / 1000);
+}
+
+AudxSegmenter *audx_segmenter_create(const AudxSegmenterConfig *config) {
+  if (!config || config->sample_rate == 0 ||
+      (config->format != AUDX_BUFFER_S16 && config->format != AUDX_BUFFER_F32))
+    return NULL;
+
+  float start = config->start_threshold > 0.0f ? config->start_threshold
+                                               : AUDX_SEGMENT_START_THRESHOLD;
+  float stop = config->stop_threshold > 0.0f ? config->stop_threshold
+                                             : AUDX_SEGMENT_STOP_THRESHOLD;
+  if (start > 1.0f || stop > start)
+    return NULL;
+
+  unsigned int rate = config->sample_rate;
+  unsigned int frame_len = calculate_frame_sample(rate);
+  unsigned int hangover_ms =
+      config->hangover_ms ? config->hangover_ms : AUDX_SEGMENT_HANGOVER_MS;
+  unsigned int preroll_ms =
+      config->preroll_ms ? config->preroll_ms : AUDX_SEGMENT_PREROLL_MS;
+  unsigned int max_ms =
+      config->max_segment_ms ? config->max_segment_ms : AUDX_SEGMENT_MAX_MS;
+  // A segment must have room for its pre-roll and the frame that opens it
+  if (frame_len == 0 ||
+      ms_to_samples(max_ms, rate) < ms_to_samples(preroll_ms, rate) + frame_len)
+    return NULL;
+
+  AudxSegmenter *seg = calloc(1, sizeof(AudxSegmenter));
+  if (!seg)
+    return NULL;
+
+  seg->start_threshold = start;
+  seg->stop_threshold = stop;
+  seg->hangover_frames = (hangover_ms + 9) / 10;
+  seg->preroll = ms_to_samples(preroll_ms, rate);
+  seg->max_segment = ms_to_samples(max_ms, rate);
+  seg->frame_len = frame_len;
+  seg->sample_size =
+      config->format == AUDX_BUFFER_S16 ? sizeof(short) : sizeof(float);
+  seg->capacity = seg->preroll + frame_len;
+  seg->ring = malloc((size_t)seg->capacity * seg->sample_size);
+  if (!seg->ring) {
+    free(seg);
+    return NULL;
+  }
+
+  return seg;
+}
+
+static void ring_write(AudxSegmenter *seg, const void *frame) {
+  const unsigned char *src = frame;
+  unsigned int pos = (unsigned int)(seg->written % seg->capacity);
+  unsigned int first = seg->capacity - pos;
+  if (first > seg->frame_len)
+    first = seg->frame_len;
+
+  memcpy(seg->ring + (size_t)pos * seg->sample_size, src,
+         (size_t)first * seg->sample_size);
+  memcpy(seg->ring, src + (size_t)first * seg->sample_size,
+         (size_t)(seg->frame_len - first) * seg->sample_size);
+  seg->written += seg->frame_len;
+}
+
+// Release [from, written) as references into the ring.
+static void emit(AudxSegmenter *seg, uint64_t from, AudxSegmentOutput *out) {
+  unsigned int count = (unsigned int)(seg->written - from);
+  unsigned int pos = (unsigned int)(from % seg->capacity);
+  unsigned int first = seg->capacity - pos;
+  if (first > count)
+    first = count;
+
+  out->data_start = from;
+  out->data[0] = seg->ring + (size_t)pos * seg->sample_size;
+  out->len[0] = first;
+  if (count > first) {
+    out->data[1] = seg->ring;
+    out->len[1] = count - first;
+  }
+  seg->emitted = seg->written;
+}
+
+int audx_segmenter_push(AudxSegmenter *seg, const void *frame, float vad_prob,
+                        AudxSegmentOutput *out) {
+  if (!seg || !frame || !out)
+    return -1;
+
+  memset(out, 0, sizeof(*out));
+  uint64_t frame_start = seg->written;
+  ring_write(seg, frame);
+
+  float threshold = seg->start_threshold;
+  if (seg->active) {
+    bool too_long = seg->written - seg->segment_start > seg->max_segment;
+    seg->silence_frames =
+        vad_prob >= seg->stop_threshold ? 0 : seg->silence_frames + 1;
+    if (!too_long && seg->silence_frames <= seg->hangover_frames) {
+      emit(seg, seg->emitted, out);
+      return 0;
+    }
+
+    // The segment ends before this frame. Speech cut off by the length
+    // limit continues straight into a new segment.
+    seg->active = false;
+    out->events |= AUDX_SEGMENT_ENDED;
+    out->end = frame_start;
+    if (!too_long)
+      return 0;
+    threshold = seg->stop_threshold;
+  }
+
+  if (vad_prob < threshold)
+    return 0;
+
+  // Pre-roll never reaches back into audio already released.
+  uint64_t from = frame_start > seg->preroll ? frame_start - seg->preroll : 0;
+  if (from < seg->emitted)
+    from = seg->emitted;
+
+  seg->active = true;
+  seg->segment_start = from;
+  seg->silence_frames = 0;
+  out->events |= AUDX_SEGMENT_STARTED;
+  out->start = from;
+  emit(seg, from, out);
+  return 0;
+}
+
+int audx_segmenter_flush(AudxSegmenter *seg, AudxSegmentOutput *out) {
+  if (!seg || !out)
+    return -1;
+
+  memset(out, 0, sizeof(*out));
+  if (seg->active) {
+    seg->active = false;
+    out->events = AUDX_SEGMENT_ENDED;
+    out->end = seg->written;
+  }
+  return 0;
+}
+
+void audx_segmenter_reset(AudxSegmenter *seg) {
+  if (!seg)
+    return;
+
+  seg->written = 0;
+  seg->emitted = 0;
+  seg->active = false;
+  seg->segment_start = 0;
+  seg->silence_frames = 0;
+}
+
+void audx_segmenter_destroy(AudxSegmenter *seg) {
+  if (!seg)
+    return;
+
+  free(seg->ring);
+  free(seg);
+}
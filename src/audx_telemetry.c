@@ -0,0 +1,183 @@
+#define AUDX_TELEMETRY_INTERNAL
+#include "audx_telemetry.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#if !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#define TELEMETRY_DEFAULT_DEADLINE_US 10000u
+#define TELEMETRY_NAME_MAX 64
+
+static pthread_mutex_t telemetry_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Atomic(AudxTelemetryHeader *) telemetry_header = NULL;
+static size_t telemetry_size = 0;
+static char telemetry_name[TELEMETRY_NAME_MAX];
+static atomic_uint_fast64_t telemetry_next_id = 1;
+
+static unsigned int hist_bucket(uint64_t ns) {
+  uint64_t us = ns / 1000;
+  unsigned int bucket = 0;
+  while (us && bucket < AUDX_TELEMETRY_HIST_BUCKETS - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+int audx_telemetry_open(const char *name, unsigned int max_streams,
+                        unsigned int deadline_us) {
+#if defined(__ANDROID__)
+  (void)name;
+  (void)max_streams;
+  (void)deadline_us;
+  return -1;
+#else
+  if (max_streams == 0)
+    return -1;
+
+  pthread_mutex_lock(&telemetry_lock);
+  if (atomic_load(&telemetry_header)) {
+    pthread_mutex_unlock(&telemetry_lock);
+    return -1;
+  }
+
+  if (name)
+    snprintf(telemetry_name, sizeof(telemetry_name), "%s", name);
+  else
+    snprintf(telemetry_name, sizeof(telemetry_name), "/audx-%d",
+             (int)getpid());
+
+  size_t header_size = (sizeof(AudxTelemetryHeader) + 63) & ~(size_t)63;
+  size_t size = header_size + (size_t)max_streams * sizeof(AudxTelemetryStream);
+
+  int fd = shm_open(telemetry_name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0) {
+    pthread_mutex_unlock(&telemetry_lock);
+    return -1;
+  }
+
+  if (ftruncate(fd, (off_t)size) != 0) {
+    close(fd);
+    shm_unlink(telemetry_name);
+    pthread_mutex_unlock(&telemetry_lock);
+    return -1;
+  }
+
+  void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    shm_unlink(telemetry_name);
+    pthread_mutex_unlock(&telemetry_lock);
+    return -1;
+  }
+
+  // ftruncate zero-fills, so all slots start free with even sequence numbers.
+  AudxTelemetryHeader *header = mem;
+  header->version = AUDX_TELEMETRY_VERSION;
+  header->header_size = (uint32_t)header_size;
+  header->stream_size = sizeof(AudxTelemetryStream);
+  header->max_streams = max_streams;
+  header->pid = (uint32_t)getpid();
+  header->deadline_us =
+      deadline_us ? deadline_us : TELEMETRY_DEFAULT_DEADLINE_US;
+
+  // Readers treat the segment as valid once the magic is visible.
+  atomic_thread_fence(memory_order_release);
+  header->magic = AUDX_TELEMETRY_MAGIC;
+
+  telemetry_size = size;
+  atomic_store(&telemetry_header, header);
+  pthread_mutex_unlock(&telemetry_lock);
+  return 0;
+#endif
+}
+
+void audx_telemetry_close(void) {
+#if !defined(__ANDROID__)
+  pthread_mutex_lock(&telemetry_lock);
+  AudxTelemetryHeader *header = atomic_exchange(&telemetry_header, NULL);
+  if (header) {
+    munmap(header, telemetry_size);
+    shm_unlink(telemetry_name);
+    telemetry_size = 0;
+  }
+  pthread_mutex_unlock(&telemetry_lock);
+#endif
+}
+
+AudxTelemetryStream *audx_telemetry_attach(unsigned int in_rate) {
+  AudxTelemetryHeader *header =
+      atomic_load_explicit(&telemetry_header, memory_order_acquire);
+  if (!header)
+    return NULL;
+
+  atomic_fetch_add(&header->streams_created, 1);
+
+  for (unsigned int i = 0; i < header->max_streams; i++) {
+    AudxTelemetryStream *slot = audx_telemetry_stream_at(header, i);
+    unsigned int expected = 0;
+    if (!atomic_compare_exchange_strong(&slot->in_use, &expected, 1))
+      continue;
+
+    unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->stream_id = atomic_fetch_add(&telemetry_next_id, 1);
+    slot->in_rate = in_rate;
+    slot->frames = 0;
+    slot->skipped = 0;
+    slot->deadline_misses = 0;
+    slot->vad_sum = 0.0;
+    memset(slot->stage_hist, 0, sizeof(slot->stage_hist));
+
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    return slot;
+  }
+
+  atomic_fetch_add(&header->streams_untracked, 1);
+  return NULL;
+}
+
+void audx_telemetry_detach(AudxTelemetryStream *slot) {
+  AudxTelemetryHeader *header = atomic_load(&telemetry_header);
+  if (!slot || !header)
+    return;
+
+  atomic_store_explicit(&slot->in_use, 0, memory_order_release);
+  atomic_fetch_add(&header->streams_destroyed, 1);
+}
+
+void audx_telemetry_publish(AudxTelemetryStream *slot, const uint64_t *stage_ns,
+                            float vad_prob, bool skipped) {
+  AudxTelemetryHeader *header =
+      atomic_load_explicit(&telemetry_header, memory_order_relaxed);
+  if (!header)
+    return;
+
+  unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+  atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  if (skipped) {
+    slot->skipped++;
+  } else {
+    slot->frames++;
+    slot->vad_sum += vad_prob;
+  }
+
+  // Stage 0 is the whole frame.
+  if (stage_ns[0] > (uint64_t)header->deadline_us * 1000)
+    slot->deadline_misses++;
+
+  for (int s = 0; s < AUDX_TELEMETRY_STAGES; s++)
+    if (stage_ns[s])
+      slot->stage_hist[s][hist_bucket(stage_ns[s])]++;
+
+  atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+}
@@ -0,0 +1,197 @@
+#define _GNU_SOURCE
+#define AUDX_TENANT_INTERNAL
+#include "audx_tenant.h"
+#include "audx_time.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TENANT_MAX_CPU_SLOTS 256
+#define TENANT_WINDOW_NS 1000000000ull
+// Step back up only well below the quota, so modes do not flap.
+#define TENANT_RECOVER_RATIO 0.8
+// How long the cost measured in a mode stays valid for stepping back up
+#define TENANT_RETRY_NS (30 * TENANT_WINDOW_NS)
+#define TENANT_MODES (AUDX_TENANT_BYPASS + 1)
+
+typedef struct TenantCpuSlot {
+  _Alignas(64) _Atomic uint64_t ns;
+} TenantCpuSlot;
+
+struct AudxTenant {
+  uint32_t id;
+  TenantCpuSlot *slots;
+  _Atomic double quota_cores; // 0 = unlimited
+  atomic_int mode;
+  _Atomic uint64_t window_start_ns;
+  _Atomic uint64_t window_base_ns; // Charged total at window start
+  // Share of a core used in the last window spent in each mode, and when
+  _Atomic double mode_share[TENANT_MODES];
+  _Atomic uint64_t mode_share_ns[TENANT_MODES];
+};
+
+static AudxTenant tenants[AUDX_MAX_TENANTS];
+static atomic_uint tenant_count = 0;
+static pthread_mutex_t tenant_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int cpu_slots = 1;
+static pthread_once_t cpu_slots_once = PTHREAD_ONCE_INIT;
+
+static void init_cpu_slots(void) {
+  long n = sysconf(_SC_NPROCESSORS_CONF);
+  if (n > TENANT_MAX_CPU_SLOTS)
+    n = TENANT_MAX_CPU_SLOTS;
+  cpu_slots = n > 0 ? (unsigned int)n : 1;
+}
+
+// Tenants are appended and never removed, so readers need no lock.
+static AudxTenant *find_tenant(uint32_t tenant_id) {
+  unsigned int count =
+      atomic_load_explicit(&tenant_count, memory_order_acquire);
+  for (unsigned int i = 0; i < count; i++)
+    if (tenants[i].id == tenant_id)
+      return &tenants[i];
+  return NULL;
+}
+
+AudxTenant *audx_tenant_get(uint32_t tenant_id) {
+  AudxTenant *tenant = find_tenant(tenant_id);
+  if (tenant)
+    return tenant;
+
+  pthread_once(&cpu_slots_once, init_cpu_slots);
+  pthread_mutex_lock(&tenant_lock);
+
+  tenant = find_tenant(tenant_id);
+  unsigned int count = atomic_load(&tenant_count);
+  if (!tenant && count < AUDX_MAX_TENANTS) {
+    TenantCpuSlot *slots = aligned_alloc(_Alignof(TenantCpuSlot),
+                                         cpu_slots * sizeof(TenantCpuSlot));
+    if (slots) {
+      for (unsigned int i = 0; i < cpu_slots; i++)
+        atomic_init(&slots[i].ns, 0);
+
+      tenant = &tenants[count];
+      tenant->id = tenant_id;
+      tenant->slots = slots;
+      atomic_init(&tenant->quota_cores, 0.0);
+      atomic_init(&tenant->mode, AUDX_TENANT_NORMAL);
+      atomic_init(&tenant->window_start_ns, audx_now_ns());
+      atomic_init(&tenant->window_base_ns, 0);
+      for (int m = 0; m < TENANT_MODES; m++) {
+        atomic_init(&tenant->mode_share[m], 0.0);
+        atomic_init(&tenant->mode_share_ns[m], 0);
+      }
+      atomic_store_explicit(&tenant_count, count + 1, memory_order_release);
+    }
+  }
+
+  pthread_mutex_unlock(&tenant_lock);
+  return tenant;
+}
+
+uint64_t audx_tenant_clock_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t merge_slots(const AudxTenant *tenant) {
+  uint64_t total = 0;
+  for (unsigned int i = 0; i < cpu_slots; i++)
+    total += atomic_load_explicit(&tenant->slots[i].ns, memory_order_relaxed);
+  return total;
+}
+
+/**
+ * Whether a tenant would fit the quota back in a mode, judged by the cost
+ * last measured there; usage in a cheaper mode says nothing about it. The
+ * measurement expires after TENANT_RETRY_NS, so a tenant whose load dropped
+ * gets another try, at most that often.
+ */
+static bool mode_fits(const AudxTenant *tenant, int mode, double quota,
+                      uint64_t now) {
+  uint64_t at =
+      atomic_load_explicit(&tenant->mode_share_ns[mode], memory_order_relaxed);
+  if (at == 0 || now - at >= TENANT_RETRY_NS)
+    return true;
+  return atomic_load_explicit(&tenant->mode_share[mode],
+                              memory_order_relaxed) <
+         quota * TENANT_RECOVER_RATIO;
+}
+
+static void evaluate_quota(AudxTenant *tenant, uint64_t now) {
+  uint64_t start =
+      atomic_load_explicit(&tenant->window_start_ns, memory_order_relaxed);
+  if (now - start < TENANT_WINDOW_NS)
+    return;
+
+  // One thread per window does the merge; the rest carry on.
+  if (!atomic_compare_exchange_strong(&tenant->window_start_ns, &start, now))
+    return;
+
+  uint64_t total = merge_slots(tenant);
+  uint64_t used = total - atomic_exchange(&tenant->window_base_ns, total);
+  double quota = atomic_load_explicit(&tenant->quota_cores,
+                                      memory_order_relaxed);
+  if (quota <= 0.0)
+    return;
+
+  double share = (double)used / (double)(now - start);
+  int mode = atomic_load_explicit(&tenant->mode, memory_order_relaxed);
+  atomic_store_explicit(&tenant->mode_share[mode], share,
+                        memory_order_relaxed);
+  atomic_store_explicit(&tenant->mode_share_ns[mode], now,
+                        memory_order_relaxed);
+
+  if (share > quota && mode < AUDX_TENANT_BYPASS)
+    mode++;
+  else if (share < quota * TENANT_RECOVER_RATIO &&
+           mode > AUDX_TENANT_NORMAL &&
+           mode_fits(tenant, mode - 1, quota, now))
+    mode--;
+  atomic_store_explicit(&tenant->mode, mode, memory_order_relaxed);
+}
+
+void audx_tenant_charge(AudxTenant *tenant, uint64_t cpu_ns) {
+  int cpu = sched_getcpu();
+  unsigned int slot = cpu >= 0 ? (unsigned int)cpu % cpu_slots : 0;
+  // Relaxed add on a line only this core normally touches.
+  atomic_fetch_add_explicit(&tenant->slots[slot].ns, cpu_ns,
+                            memory_order_relaxed);
+
+  if (atomic_load_explicit(&tenant->quota_cores, memory_order_relaxed) > 0.0)
+    evaluate_quota(tenant, audx_now_ns());
+}
+
+AudxTenantMode audx_tenant_current_mode(const AudxTenant *tenant) {
+  return (AudxTenantMode)atomic_load_explicit(&tenant->mode,
+                                              memory_order_relaxed);
+}
+
+int audx_tenant_set_quota(uint32_t tenant_id, double cores) {
+  if (!(cores >= 0.0))
+    return -1;
+
+  AudxTenant *tenant = audx_tenant_get(tenant_id);
+  if (!tenant)
+    return -1;
+
+  atomic_store(&tenant->quota_cores, cores);
+  if (cores == 0.0)
+    atomic_store(&tenant->mode, AUDX_TENANT_NORMAL);
+  return 0;
+}
+
+uint64_t audx_tenant_cpu_ns(uint32_t tenant_id) {
+  AudxTenant *tenant = find_tenant(tenant_id);
+  return tenant ? merge_slots(tenant) : 0;
+}
+
+AudxTenantMode audx_tenant_mode(uint32_t tenant_id) {
+  AudxTenant *tenant = find_tenant(tenant_id);
+  return tenant ? audx_tenant_current_mode(tenant) : AUDX_TENANT_NORMAL;
+}
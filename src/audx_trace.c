@@ -0,0 +1,216 @@
+#define AUDX_TIME_IMPL
+#include "audx_time.h"
+#define AUDX_TRACE_INTERNAL
+#include "audx_trace.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Per-thread ring capacity (power of two). At 100 frames/s and six stages,
+// one buffer holds several seconds of events for a hundred streams.
+#define TRACE_RING_SIZE (1u << 15)
+#define TRACE_FLUSH_INTERVAL_NS 20000000L
+
+static const char *stage_names[AUDX_TRACE_EVENT_COUNT] = {
+    "frame",      "convert_in",  "upsample",  "denoise",
+    "downsample", "convert_out", "pool_wait", "pool_batch",
+};
+
+typedef struct TraceEvent {
+  uint64_t begin_ns;
+  uint64_t end_ns;
+  const void *stream;
+  uint64_t frame;
+  uint32_t stage;
+} TraceEvent;
+
+/**
+ * Single-producer/single-consumer ring owned by one thread at a time.
+ * Buffers are never freed; when a thread exits its buffer is released and
+ * may be claimed by a new thread.
+ */
+typedef struct TraceBuffer {
+  struct TraceBuffer *next;
+  atomic_bool owned;
+  unsigned int tid;
+  _Atomic uint32_t head; // written by producer
+  _Atomic uint32_t tail; // written by flusher
+  TraceEvent events[TRACE_RING_SIZE];
+} TraceBuffer;
+
+atomic_bool audx_trace_active = false;
+
+static _Atomic(TraceBuffer *) trace_buffers = NULL;
+static atomic_uint trace_next_tid = 1;
+static _Atomic uint64_t trace_dropped = 0;
+
+static _Thread_local TraceBuffer *tls_buffer = NULL;
+static pthread_key_t trace_key;
+static pthread_once_t trace_key_once = PTHREAD_ONCE_INIT;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t trace_thread;
+static atomic_bool trace_running = false;
+static FILE *trace_file = NULL;
+static bool trace_first_event = true;
+static uint64_t trace_origin_ns = 0;
+
+static void release_buffer(void *ptr) {
+  TraceBuffer *buf = ptr;
+  if (buf)
+    atomic_store_explicit(&buf->owned, false, memory_order_release);
+}
+
+static void make_key(void) { pthread_key_create(&trace_key, release_buffer); }
+
+static TraceBuffer *acquire_buffer(void) {
+  pthread_once(&trace_key_once, make_key);
+
+  // Reuse a buffer released by an exited thread before allocating.
+  TraceBuffer *buf = atomic_load_explicit(&trace_buffers, memory_order_acquire);
+  for (; buf; buf = buf->next) {
+    bool expected = false;
+    if (atomic_compare_exchange_strong(&buf->owned, &expected, true))
+      break;
+  }
+
+  if (!buf) {
+    buf = calloc(1, sizeof(TraceBuffer));
+    if (!buf)
+      return NULL;
+    atomic_init(&buf->owned, true);
+    buf->tid = atomic_fetch_add(&trace_next_tid, 1);
+
+    TraceBuffer *head = atomic_load(&trace_buffers);
+    do {
+      buf->next = head;
+    } while (!atomic_compare_exchange_weak(&trace_buffers, &head, buf));
+  }
+
+  pthread_setspecific(trace_key, buf);
+  tls_buffer = buf;
+  return buf;
+}
+
+void audx_trace_record(AudxTraceStage stage, uint64_t begin_ns,
+                       uint64_t end_ns, const void *stream, uint64_t frame) {
+  TraceBuffer *buf = tls_buffer;
+  if (!buf) {
+    buf = acquire_buffer();
+    if (!buf)
+      return;
+  }
+
+  uint32_t head = atomic_load_explicit(&buf->head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&buf->tail, memory_order_acquire);
+  if (head - tail >= TRACE_RING_SIZE) {
+    atomic_fetch_add_explicit(&trace_dropped, 1, memory_order_relaxed);
+    return;
+  }
+
+  TraceEvent *ev = &buf->events[head & (TRACE_RING_SIZE - 1)];
+  ev->begin_ns = begin_ns;
+  ev->end_ns = end_ns;
+  ev->stream = stream;
+  ev->frame = frame;
+  ev->stage = stage;
+  atomic_store_explicit(&buf->head, head + 1, memory_order_release);
+}
+
+static void drain_buffers(void) {
+  int pid = (int)getpid();
+  TraceBuffer *buf = atomic_load_explicit(&trace_buffers, memory_order_acquire);
+  for (; buf; buf = buf->next) {
+    uint32_t tail = atomic_load_explicit(&buf->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&buf->head, memory_order_acquire);
+
+    for (; tail != head; tail++) {
+      const TraceEvent *ev = &buf->events[tail & (TRACE_RING_SIZE - 1)];
+      // Events recorded before this session started are discarded.
+      if (ev->begin_ns >= trace_origin_ns &&
+          ev->stage < AUDX_TRACE_EVENT_COUNT) {
+        fprintf(trace_file,
+                "%s{\"name\":\"%s\",\"cat\":\"audx\",\"ph\":\"X\","
+                "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,"
+                "\"args\":{\"stream\":\"%p\",\"frame\":%llu}}",
+                trace_first_event ? "\n" : ",\n", stage_names[ev->stage],
+                (ev->begin_ns - trace_origin_ns) / 1e3,
+                (ev->end_ns - ev->begin_ns) / 1e3, pid, buf->tid, ev->stream,
+                (unsigned long long)ev->frame);
+        trace_first_event = false;
+      }
+    }
+    atomic_store_explicit(&buf->tail, tail, memory_order_release);
+  }
+  fflush(trace_file);
+}
+
+static void *flusher_main(void *arg) {
+  (void)arg;
+  struct timespec interval = {0, TRACE_FLUSH_INTERVAL_NS};
+  while (atomic_load(&trace_running)) {
+    nanosleep(&interval, NULL);
+    drain_buffers();
+  }
+  return NULL;
+}
+
+int audx_trace_start(const char *path) {
+  if (!path)
+    return -1;
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_file) {
+    pthread_mutex_unlock(&trace_lock);
+    return -1;
+  }
+
+  trace_file = fopen(path, "w");
+  if (!trace_file) {
+    pthread_mutex_unlock(&trace_lock);
+    return -1;
+  }
+
+  fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", trace_file);
+  trace_first_event = true;
+  trace_origin_ns = audx_now_ns();
+
+  atomic_store(&trace_running, true);
+  if (pthread_create(&trace_thread, NULL, flusher_main, NULL) != 0) {
+    atomic_store(&trace_running, false);
+    fclose(trace_file);
+    trace_file = NULL;
+    pthread_mutex_unlock(&trace_lock);
+    return -1;
+  }
+
+  atomic_store(&audx_trace_active, true);
+  pthread_mutex_unlock(&trace_lock);
+  return 0;
+}
+
+void audx_trace_stop(void) {
+  pthread_mutex_lock(&trace_lock);
+  if (!trace_file) {
+    pthread_mutex_unlock(&trace_lock);
+    return;
+  }
+
+  atomic_store(&audx_trace_active, false);
+  atomic_store(&trace_running, false);
+  pthread_join(trace_thread, NULL);
+
+  drain_buffers();
+  fputs("\n]}\n", trace_file);
+  fclose(trace_file);
+  trace_file = NULL;
+  pthread_mutex_unlock(&trace_lock);
+}
+
+bool audx_trace_enabled(void) {
+  return atomic_load_explicit(&audx_trace_active, memory_order_relaxed);
+}
+
+uint64_t audx_trace_dropped(void) { return atomic_load(&trace_dropped); }
@@ -0,0 +1,269 @@
+/*
+ * Band kernels for RNNoise's denoise.c, replacing its windowing, band energy
+ * and correlation, band-to-bin gain interpolation and pitch filter when
+ * AUDX_RNNOISE_BANDS is on.
+ *
+ * This file is built in place of denoise.c. CMake applies denoise.patch to a
+ * copy of denoise.c, which renames the originals to *_generic and declares
+ * the kernels in their place, and the copy is included below so that the
+ * kernels can stand in for static functions. They use denoise.c's own band
+ * edges and rnnoise_tables.c's window, so there is nothing to set up at run
+ * time. audx_bench_rnnoise checks them against the originals.
+ */
+
+#include "denoise_audx.c"
+
+#include "audx_bands.h"
+#include "audx_simd.h"
+#include <math.h>
+#include <string.h>
+
+#define W AUDX_SIMD_WIDTH
+
+// rnnoise_tables.c
+extern const float rnn_half_window[];
+
+#if W > 1
+// Lane offsets for the interpolation weights of a block of bins
+static const float lane[16] = {0, 1, 2,  3,  4,  5,  6,  7,
+                               8, 9, 10, 11, 12, 13, 14, 15};
+
+static inline vf vf_reverse(vf v) {
+#if W == 16
+  return __builtin_shufflevector(v, v, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5,
+                                 4, 3, 2, 1, 0);
+#elif W == 8
+  return __builtin_shufflevector(v, v, 7, 6, 5, 4, 3, 2, 1, 0);
+#else
+  return __builtin_shufflevector(v, v, 3, 2, 1, 0);
+#endif
+}
+#endif
+
+/* --- Analysis and synthesis window --- */
+
+// Both halves of the window at once; the second runs the table backwards
+static void apply_window(float *x) {
+  const float *w = rnn_half_window;
+  int i = 0;
+#if W > 1
+  for (; i + W <= FRAME_SIZE; i += W) {
+    vf h = LD(vf, w + i);
+    float *y = x + WINDOW_SIZE - W - i;
+    ST(vf, x + i, LD(vf, x + i) * h);
+    ST(vf, y, LD(vf, y) * vf_reverse(h));
+  }
+#endif
+  for (; i < FRAME_SIZE; i++) {
+    x[i] *= w[i];
+    x[WINDOW_SIZE - 1 - i] *= w[i];
+  }
+}
+
+/* --- Band energy and correlation --- */
+
+// p[k] = Re(a[k] conj(b[k])), in 4-wide blocks of two complex values
+static void bin_products(float *restrict p, const kiss_fft_cpx *a,
+                         const kiss_fft_cpx *b) {
+  int k = 0;
+#if W > 1
+  const float *x = (const float *)a, *y = (const float *)b;
+  for (; k + 4 <= FREQ_SIZE; k += 4) {
+    vf4 s0 = LD(vf4, x + 2 * k) * LD(vf4, y + 2 * k);
+    vf4 s1 = LD(vf4, x + 2 * k + 4) * LD(vf4, y + 2 * k + 4);
+    ST(vf4, p + k,
+       __builtin_shufflevector(s0, s1, 0, 2, 4, 6) +
+           __builtin_shufflevector(s0, s1, 1, 3, 5, 7));
+  }
+#endif
+  for (; k < FREQ_SIZE; k++)
+    p[k] = a[k].r * b[k].r + a[k].i * b[k].i;
+}
+
+/**
+ * Spread per-bin products over the bands as denoise.c does: bin j of the n
+ * between two band edges goes to the lower band by 1 - j/n and to the upper
+ * band by j/n. The end bands only get half a triangle and are doubled.
+ */
+static void band_sums(float *bandE, const float *p) {
+  float sum[NB_BANDS] = {0};
+  for (int i = 0; i < NB_BANDS - 1; i++) {
+    const int start = eband20ms[i], n = eband20ms[i + 1] - start;
+    const float step = 1.0f / n;
+    const float *x = p + start;
+    float lo = 0.0f, hi = 0.0f;
+    int j = 0;
+#if W > 1
+    vf lo_v = {0}, hi_v = {0};
+    for (; j + W <= n; j += W) {
+      vf frac = (LD(vf, lane) + (float)j) * step;
+      vf v = LD(vf, x + j);
+      lo_v += (1.0f - frac) * v;
+      hi_v += frac * v;
+    }
+    lo = vf_sum(lo_v);
+    hi = vf_sum(hi_v);
+#endif
+#if W > 4
+    // Low bands are only a few bins wide
+    for (; j + 4 <= n; j += 4) {
+      vf4 frac = (LD(vf4, lane) + (float)j) * step;
+      vf4 v = LD(vf4, x + j);
+      vf4 l = (1.0f - frac) * v, h = frac * v;
+      lo += l[0] + l[1] + l[2] + l[3];
+      hi += h[0] + h[1] + h[2] + h[3];
+    }
+#endif
+    for (; j < n; j++) {
+      float frac = j * step;
+      lo += (1.0f - frac) * x[j];
+      hi += frac * x[j];
+    }
+    sum[i] += lo;
+    sum[i + 1] += hi;
+  }
+  sum[0] *= 2;
+  sum[NB_BANDS - 1] *= 2;
+  memcpy(bandE, sum, sizeof(sum));
+}
+
+void compute_band_energy(float *bandE, const kiss_fft_cpx *X) {
+  _Alignas(64) float p[FREQ_SIZE];
+  bin_products(p, X, X);
+  band_sums(bandE, p);
+}
+
+void compute_band_corr(float *bandE, const kiss_fft_cpx *X,
+                       const kiss_fft_cpx *P) {
+  _Alignas(64) float p[FREQ_SIZE];
+  bin_products(p, X, P);
+  band_sums(bandE, p);
+}
+
+/* --- Band-to-bin gain interpolation --- */
+
+/**
+ * Linear between band edges, with the weights of band_sums(). Bins above the
+ * last edge are left alone; denoise.c's callers zero g beforehand.
+ */
+void interp_band_gain(float *g, const float *bandE) {
+  for (int i = 0; i < NB_BANDS - 1; i++) {
+    const int start = eband20ms[i], n = eband20ms[i + 1] - start;
+    const float step = 1.0f / n, e0 = bandE[i], e1 = bandE[i + 1];
+    float *y = g + start;
+    int j = 0;
+#if W > 1
+    for (; j + W <= n; j += W) {
+      vf frac = (LD(vf, lane) + (float)j) * step;
+      ST(vf, y + j, (1.0f - frac) * e0 + frac * e1);
+    }
+#endif
+#if W > 4
+    for (; j + 4 <= n; j += 4) {
+      vf4 frac = (LD(vf4, lane) + (float)j) * step;
+      ST(vf4, y + j, (1.0f - frac) * e0 + frac * e1);
+    }
+#endif
+    for (; j < n; j++) {
+      float frac = j * step;
+      y[j] = (1.0f - frac) * e0 + frac * e1;
+    }
+  }
+}
+
+/* --- Pitch filter --- */
+
+// X[k] += g[k] P[k], in 4-wide blocks of two complex values
+static void bins_mul_add(kiss_fft_cpx *X, const float *g,
+                         const kiss_fft_cpx *P) {
+  int k = 0;
+#if W > 1
+  float *x = (float *)X;
+  const float *p = (const float *)P;
+  for (; k + 4 <= FREQ_SIZE; k += 4) {
+    vf4 gv = LD(vf4, g + k);
+    ST(vf4, x + 2 * k,
+       LD(vf4, x + 2 * k) +
+           __builtin_shufflevector(gv, gv, 0, 0, 1, 1) * LD(vf4, p + 2 * k));
+    ST(vf4, x + 2 * k + 4,
+       LD(vf4, x + 2 * k + 4) +
+           __builtin_shufflevector(gv, gv, 2, 2, 3, 3) *
+               LD(vf4, p + 2 * k + 4));
+  }
+#endif
+  for (; k < FREQ_SIZE; k++) {
+    X[k].r += g[k] * P[k].r;
+    X[k].i += g[k] * P[k].i;
+  }
+}
+
+// X[k] *= g[k]
+static void bins_scale(kiss_fft_cpx *X, const float *g) {
+  int k = 0;
+#if W > 1
+  float *x = (float *)X;
+  for (; k + 4 <= FREQ_SIZE; k += 4) {
+    vf4 gv = LD(vf4, g + k);
+    ST(vf4, x + 2 * k,
+       LD(vf4, x + 2 * k) * __builtin_shufflevector(gv, gv, 0, 0, 1, 1));
+    ST(vf4, x + 2 * k + 4,
+       LD(vf4, x + 2 * k + 4) * __builtin_shufflevector(gv, gv, 2, 2, 3, 3));
+  }
+#endif
+  for (; k < FREQ_SIZE; k++) {
+    X[k].r *= g[k];
+    X[k].i *= g[k];
+  }
+}
+
+/**
+ * Mix in the pitch-delayed spectrum by a per-band gain from the pitch
+ * correlation and the network's gain, then restore the original band
+ * energies. Per-band math follows RNNoise, including its double-precision
+ * square roots.
+ */
+void rnn_pitch_filter(kiss_fft_cpx *X, const kiss_fft_cpx *P,
+                      const float *Ex, const float *Ep, const float *Exp,
+                      const float *g) {
+  float r[NB_BANDS], newE[NB_BANDS], norm[NB_BANDS];
+  _Alignas(64) float rf[FREQ_SIZE] = {0};
+  _Alignas(64) float normf[FREQ_SIZE] = {0};
+
+  for (int i = 0; i < NB_BANDS; i++) {
+    if (Exp[i] > g[i])
+      r[i] = 1;
+    else
+      r[i] = Exp[i] * Exp[i] * (1 - g[i] * g[i]) /
+             (.001 + g[i] * g[i] * (1 - Exp[i] * Exp[i]));
+    r[i] = sqrt(fminf(1, fmaxf(0, r[i])));
+    r[i] *= sqrt(Ex[i] / (1e-8 + Ep[i]));
+  }
+  interp_band_gain(rf, r);
+  bins_mul_add(X, rf, P);
+
+  compute_band_energy(newE, X);
+  for (int i = 0; i < NB_BANDS; i++)
+    norm[i] = sqrt(Ex[i] / (1e-8 + newE[i]));
+  interp_band_gain(normf, norm);
+  bins_scale(X, normf);
+}
+
+/* --- Checks and benchmarks --- */
+
+static const AudxBandKernels kernels = {
+    .bands = NB_BANDS,
+    .bins = FREQ_SIZE,
+    .window = WINDOW_SIZE,
+    .apply_window = apply_window,
+    .apply_window_generic = apply_window_generic,
+    .band_energy = compute_band_energy,
+    .band_energy_generic = compute_band_energy_generic,
+    .band_corr = compute_band_corr,
+    .band_corr_generic = compute_band_corr_generic,
+    .interp_band_gain = interp_band_gain,
+    .interp_band_gain_generic = interp_band_gain_generic,
+    .pitch_filter = rnn_pitch_filter,
+    .pitch_filter_generic = rnn_pitch_filter_generic,
+};
+
+const AudxBandKernels *audx_band_kernels(void) { return &kernels; }
@@ -0,0 +1,500 @@
+#include "audx_fft.h"
+#include "audx_simd.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FFT_HALF (AUDX_FFT_SIZE / 2)
+#define FFT_STAGES 5
+// Sum of (radix - 1) * n / radix over the stages of the plan
+#define FFT_TWIDDLES 479
+
+// Each pass vectorizes over the contiguous stride index; stages whose stride
+// is narrower than a register fall back to 4-wide vectors, then scalars.
+#define FFT_WIDTH AUDX_SIMD_WIDTH
+
+// Stockham radices; the first stage has stride 1, the last stride 96.
+static const unsigned int radices[FFT_STAGES] = {4, 4, 2, 3, 5};
+
+static struct {
+  float tw_re[FFT_TWIDDLES];
+  float tw_im[FFT_TWIDDLES];
+  unsigned int tw_offset[FFT_STAGES];
+  // e^(-2 pi i k / N) for the real split, k = 0..N/2
+  float split_re[FFT_HALF + 1];
+  float split_im[FFT_HALF + 1];
+} plan;
+
+static pthread_once_t plan_once = PTHREAD_ONCE_INIT;
+
+static void plan_init(void) {
+  unsigned int n = FFT_HALF;
+  unsigned int offset = 0;
+  for (int stage = 0; stage < FFT_STAGES; stage++) {
+    unsigned int p = radices[stage];
+    unsigned int m = n / p;
+    plan.tw_offset[stage] = offset;
+    for (unsigned int r = 1; r < p; r++) {
+      for (unsigned int q = 0; q < m; q++) {
+        double angle = -2.0 * M_PI * (double)(r * q) / (double)n;
+        plan.tw_re[offset + (r - 1) * m + q] = (float)cos(angle);
+        plan.tw_im[offset + (r - 1) * m + q] = (float)sin(angle);
+      }
+    }
+    offset += (p - 1) * m;
+    n = m;
+  }
+
+  for (unsigned int k = 0; k <= FFT_HALF; k++) {
+    double angle = -2.0 * M_PI * (double)k / (double)AUDX_FFT_SIZE;
+    plan.split_re[k] = (float)cos(angle);
+    plan.split_im[k] = (float)sin(angle);
+  }
+}
+
+// y = (ar + i ai) * (wr + i wi), stored at index o
+#define STORE_TWIDDLED(T, o, ar, ai, wr, wi)                                  \
+  do {                                                                        \
+    ST(T, yr + (o), (ar) * (wr) - (ai) * (wi));                               \
+    ST(T, yi + (o), (ar) * (wi) + (ai) * (wr));                               \
+  } while (0)
+
+/*
+ * One butterfly per stage and stride index t: inputs at t + s * (q + r * m),
+ * outputs at t + s * (p * q + r), output r multiplied by w^(r * q).
+ */
+
+#define RADIX2(T, t)                                                          \
+  do {                                                                        \
+    size_t i0 = (t) + s * q, i1 = i0 + s * m, o = (t) + s * 2 * q;            \
+    T a0r = LD(T, xr + i0), a0i = LD(T, xi + i0);                             \
+    T a1r = LD(T, xr + i1), a1i = LD(T, xi + i1);                             \
+    ST(T, yr + o, a0r + a1r);                                                 \
+    ST(T, yi + o, a0i + a1i);                                                 \
+    STORE_TWIDDLED(T, o + s, a0r - a1r, a0i - a1i, w1r, w1i);                 \
+  } while (0)
+
+#define RADIX3(T, t)                                                          \
+  do {                                                                        \
+    const float c = -0.5f, sn = 0.86602540378443864676f;                      \
+    size_t i0 = (t) + s * q, o = (t) + s * 3 * q;                             \
+    T a0r = LD(T, xr + i0), a0i = LD(T, xi + i0);                             \
+    T a1r = LD(T, xr + i0 + s * m), a1i = LD(T, xi + i0 + s * m);             \
+    T a2r = LD(T, xr + i0 + 2 * s * m), a2i = LD(T, xi + i0 + 2 * s * m);     \
+    T tr = a1r + a2r, ti = a1i + a2i;                                         \
+    T mr = a0r + tr * c, mi = a0i + ti * c;                                   \
+    /* -i * sin(2 pi / 3) * (a1 - a2) */                                      \
+    T nr = (a1i - a2i) * sn, ni = (a2r - a1r) * sn;                           \
+    ST(T, yr + o, a0r + tr);                                                  \
+    ST(T, yi + o, a0i + ti);                                                  \
+    STORE_TWIDDLED(T, o + s, mr + nr, mi + ni, w1r, w1i);                     \
+    STORE_TWIDDLED(T, o + 2 * s, mr - nr, mi - ni, w2r, w2i);                 \
+  } while (0)
+
+#define RADIX4(T, t)                                                          \
+  do {                                                                        \
+    size_t i0 = (t) + s * q, o = (t) + s * 4 * q;                             \
+    T a0r = LD(T, xr + i0), a0i = LD(T, xi + i0);                             \
+    T a1r = LD(T, xr + i0 + s * m), a1i = LD(T, xi + i0 + s * m);             \
+    T a2r = LD(T, xr + i0 + 2 * s * m), a2i = LD(T, xi + i0 + 2 * s * m);     \
+    T a3r = LD(T, xr + i0 + 3 * s * m), a3i = LD(T, xi + i0 + 3 * s * m);     \
+    T t0r = a0r + a2r, t0i = a0i + a2i;                                       \
+    T t1r = a0r - a2r, t1i = a0i - a2i;                                       \
+    T t2r = a1r + a3r, t2i = a1i + a3i;                                       \
+    T t3r = a1r - a3r, t3i = a1i - a3i;                                       \
+    ST(T, yr + o, t0r + t2r);                                                 \
+    ST(T, yi + o, t0i + t2i);                                                 \
+    /* b1 = t1 - i t3, b3 = t1 + i t3 */                                      \
+    STORE_TWIDDLED(T, o + s, t1r + t3i, t1i - t3r, w1r, w1i);                 \
+    STORE_TWIDDLED(T, o + 2 * s, t0r - t2r, t0i - t2i, w2r, w2i);             \
+    STORE_TWIDDLED(T, o + 3 * s, t1r - t3i, t1i + t3r, w3r, w3i);             \
+  } while (0)
+
+#define RADIX5(T, t)                                                          \
+  do {                                                                        \
+    const float c1 = 0.30901699437494742410f, c2 = -0.80901699437494742410f;  \
+    const float s1 = 0.95105651629515357212f, s2 = 0.58778525229247312917f;   \
+    size_t i0 = (t) + s * q, o = (t) + s * 5 * q;                             \
+    T a0r = LD(T, xr + i0), a0i = LD(T, xi + i0);                             \
+    T a1r = LD(T, xr + i0 + s * m), a1i = LD(T, xi + i0 + s * m);             \
+    T a2r = LD(T, xr + i0 + 2 * s * m), a2i = LD(T, xi + i0 + 2 * s * m);     \
+    T a3r = LD(T, xr + i0 + 3 * s * m), a3i = LD(T, xi + i0 + 3 * s * m);     \
+    T a4r = LD(T, xr + i0 + 4 * s * m), a4i = LD(T, xi + i0 + 4 * s * m);     \
+    T t1r = a1r + a4r, t1i = a1i + a4i, d1r = a1r - a4r, d1i = a1i - a4i;     \
+    T t2r = a2r + a3r, t2i = a2i + a3i, d2r = a2r - a3r, d2i = a2i - a3i;     \
+    T u1r = a0r + t1r * c1 + t2r * c2, u1i = a0i + t1i * c1 + t2i * c2;       \
+    T u2r = a0r + t1r * c2 + t2r * c1, u2i = a0i + t1i * c2 + t2i * c1;       \
+    T v1r = d1r * s1 + d2r * s2, v1i = d1i * s1 + d2i * s2;                   \
+    T v2r = d1r * s2 - d2r * s1, v2i = d1i * s2 - d2i * s1;                   \
+    ST(T, yr + o, a0r + t1r + t2r);                                           \
+    ST(T, yi + o, a0i + t1i + t2i);                                           \
+    /* b1,4 = u1 -/+ i v1, b2,3 = u2 -/+ i v2 */                              \
+    STORE_TWIDDLED(T, o + s, u1r + v1i, u1i - v1r, w1r, w1i);                 \
+    STORE_TWIDDLED(T, o + 2 * s, u2r + v2i, u2i - v2r, w2r, w2i);             \
+    STORE_TWIDDLED(T, o + 3 * s, u2r - v2i, u2i + v2r, w3r, w3i);             \
+    STORE_TWIDDLED(T, o + 4 * s, u1r - v1i, u1i + v1r, w4r, w4i);             \
+  } while (0)
+
+// Run BUTTERFLY over the stride index with the widest vectors that fit.
+// Every stride after the first stage is a multiple of 4, so vector builds
+// need no scalar tail.
+#if FFT_WIDTH > 4
+#define FOR_STRIDE(BUTTERFLY)                                                 \
+  do {                                                                        \
+    size_t t = 0;                                                             \
+    for (; t + FFT_WIDTH <= s; t += FFT_WIDTH)                                \
+      BUTTERFLY(vf, t);                                                       \
+    for (; t < s; t += 4)                                                     \
+      BUTTERFLY(vf4, t);                                                      \
+  } while (0)
+#elif FFT_WIDTH > 1
+#define FOR_STRIDE(BUTTERFLY)                                                 \
+  do {                                                                        \
+    for (size_t t = 0; t < s; t += FFT_WIDTH)                                 \
+      BUTTERFLY(vf, t);                                                       \
+  } while (0)
+#else
+#define FOR_STRIDE(BUTTERFLY)                                                 \
+  do {                                                                        \
+    for (size_t t = 0; t < s; t++)                                            \
+      BUTTERFLY(float, t);                                                    \
+  } while (0)
+#endif
+
+// Twiddles w^(r * q) for r = 1..P-1 as scalars
+#define LOAD_TWIDDLES(P)                                                      \
+  float w1r = twr[q], w1i = twi[q];                                           \
+  float w2r = P > 2 ? twr[m + q] : 0.0f, w2i = P > 2 ? twi[m + q] : 0.0f;     \
+  float w3r = P > 3 ? twr[2 * m + q] : 0.0f;                                  \
+  float w3i = P > 3 ? twi[2 * m + q] : 0.0f;                                  \
+  float w4r = P > 4 ? twr[3 * m + q] : 0.0f;                                  \
+  float w4i = P > 4 ? twi[3 * m + q] : 0.0f;                                  \
+  (void)w2r, (void)w2i, (void)w3r, (void)w3i, (void)w4r, (void)w4i
+
+#define DEFINE_PASS(P)                                                        \
+  static inline void pass##P(size_t n, size_t s, const float *restrict twr,   \
+                             const float *restrict twi,                       \
+                             const float *restrict xr,                        \
+                             const float *restrict xi, float *restrict yr,    \
+                             float *restrict yi) {                            \
+    const size_t m = n / P;                                                   \
+    for (size_t q = 0; q < m; q++) {                                          \
+      LOAD_TWIDDLES(P);                                                       \
+      FOR_STRIDE(RADIX##P);                                                   \
+    }                                                                         \
+  }
+
+DEFINE_PASS(2)
+DEFINE_PASS(3)
+DEFINE_PASS(4)
+DEFINE_PASS(5)
+
+#if FFT_WIDTH > 1
+/**
+ * Store y[4 q + r] = v_r[q] for the lanes of four vectors. Interleaving in
+ * registers keeps the next stage's vector loads from stalling on store
+ * forwarding of single lanes.
+ */
+static inline void store_interleaved4(float *y, vf v0, vf v1, vf v2, vf v3) {
+  union {
+    vf v;
+    vf4 part[FFT_WIDTH / 4];
+  } a = {v0}, b = {v1}, c = {v2}, d = {v3};
+
+  for (int g = 0; g < FFT_WIDTH / 4; g++) {
+    vf4 t0 = __builtin_shufflevector(a.part[g], b.part[g], 0, 4, 1, 5);
+    vf4 t1 = __builtin_shufflevector(a.part[g], b.part[g], 2, 6, 3, 7);
+    vf4 t2 = __builtin_shufflevector(c.part[g], d.part[g], 0, 4, 1, 5);
+    vf4 t3 = __builtin_shufflevector(c.part[g], d.part[g], 2, 6, 3, 7);
+    ST(vf4, y + 16 * g, __builtin_shufflevector(t0, t2, 0, 1, 4, 5));
+    ST(vf4, y + 16 * g + 4, __builtin_shufflevector(t0, t2, 2, 3, 6, 7));
+    ST(vf4, y + 16 * g + 8, __builtin_shufflevector(t1, t3, 0, 1, 4, 5));
+    ST(vf4, y + 16 * g + 12, __builtin_shufflevector(t1, t3, 2, 3, 6, 7));
+  }
+}
+#endif
+
+/**
+ * The first stage has stride 1, so it is vectorized across q instead: the
+ * inputs and twiddles are contiguous in q, and the four outputs of each
+ * butterfly are interleaved on store.
+ */
+static void pass4_first(const float *restrict twr, const float *restrict twi,
+                        const float *restrict xr, const float *restrict xi,
+                        float *restrict yr, float *restrict yi) {
+  const size_t s = 1, m = FFT_HALF / 4;
+  (void)s;
+  size_t q = 0;
+#if FFT_WIDTH > 1
+  for (; q + FFT_WIDTH <= m; q += FFT_WIDTH) {
+    vf a0r = LD(vf, xr + q), a0i = LD(vf, xi + q);
+    vf a1r = LD(vf, xr + q + m), a1i = LD(vf, xi + q + m);
+    vf a2r = LD(vf, xr + q + 2 * m), a2i = LD(vf, xi + q + 2 * m);
+    vf a3r = LD(vf, xr + q + 3 * m), a3i = LD(vf, xi + q + 3 * m);
+    vf t0r = a0r + a2r, t0i = a0i + a2i;
+    vf t1r = a0r - a2r, t1i = a0i - a2i;
+    vf t2r = a1r + a3r, t2i = a1i + a3i;
+    vf t3r = a1r - a3r, t3i = a1i - a3i;
+
+    vf b1r = t1r + t3i, b1i = t1i - t3r;
+    vf b2r = t0r - t2r, b2i = t0i - t2i;
+    vf b3r = t1r - t3i, b3i = t1i + t3r;
+    vf w1r = LD(vf, twr + q), w1i = LD(vf, twi + q);
+    vf w2r = LD(vf, twr + m + q), w2i = LD(vf, twi + m + q);
+    vf w3r = LD(vf, twr + 2 * m + q), w3i = LD(vf, twi + 2 * m + q);
+
+    store_interleaved4(yr + 4 * q, t0r + t2r, b1r * w1r - b1i * w1i,
+                       b2r * w2r - b2i * w2i, b3r * w3r - b3i * w3i);
+    store_interleaved4(yi + 4 * q, t0i + t2i, b1r * w1i + b1i * w1r,
+                       b2r * w2i + b2i * w2r, b3r * w3i + b3i * w3r);
+  }
+#endif
+#if FFT_WIDTH == 1 || (FFT_HALF / 4) % FFT_WIDTH != 0
+  for (; q < m; q++) {
+    LOAD_TWIDDLES(4);
+    RADIX4(float, 0);
+  }
+#endif
+}
+
+/**
+ * 480-point forward complex FFT in natural order, from x into y; x is
+ * overwritten. The plan is unrolled so every pass is inlined with constant
+ * sizes and strides.
+ */
+static void fft_half(float *restrict xr, float *restrict xi,
+                     float *restrict yr, float *restrict yi) {
+  const float *twr = plan.tw_re, *twi = plan.tw_im;
+  const unsigned int *off = plan.tw_offset;
+
+  pass4_first(twr, twi, xr, xi, yr, yi);
+  pass4(120, 4, twr + off[1], twi + off[1], yr, yi, xr, xi);
+  pass2(30, 16, twr + off[2], twi + off[2], xr, xi, yr, yi);
+  pass3(15, 32, twr + off[3], twi + off[3], yr, yi, xr, xi);
+  pass5(5, 96, twr + off[4], twi + off[4], xr, xi, yr, yi);
+}
+
+void audx_fft_forward(const float *in, float *re, float *im) {
+  pthread_once(&plan_once, plan_init);
+
+  _Alignas(64) float zr[FFT_HALF], zi[FFT_HALF];
+  for (int n = 0; n < FFT_HALF; n++) {
+    zr[n] = in[2 * n];
+    zi[n] = in[2 * n + 1];
+  }
+
+  _Alignas(64) float Zr[FFT_HALF], Zi[FFT_HALF];
+  fft_half(zr, zi, Zr, Zi);
+
+  // Split the transform of the even/odd pairs into the real spectrum:
+  // X[k] = E[k] + W^k O[k], E = (Z[k] + Z*[-k]) / 2, O = -i (Z[k] - Z*[-k]) / 2
+  re[0] = Zr[0] + Zi[0];
+  im[0] = 0.0f;
+  re[FFT_HALF] = Zr[0] - Zi[0];
+  im[FFT_HALF] = 0.0f;
+  for (int k = 1; k < FFT_HALF; k++) {
+    float ar = Zr[k], ai = Zi[k];
+    float br = Zr[FFT_HALF - k], bi = -Zi[FFT_HALF - k];
+    float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+    float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+    float wr = plan.split_re[k], wi = plan.split_im[k];
+    re[k] = er + or_ * wr - oi * wi;
+    im[k] = ei + or_ * wi + oi * wr;
+  }
+}
+
+void audx_fft_inverse(const float *re, const float *im, float *out) {
+  pthread_once(&plan_once, plan_init);
+
+  // Merge into Z = E + i O with E = X[k] + X*[N/2 - k] and
+  // O = (X[k] - X*[N/2 - k]) W^-k, then take the unscaled inverse 480-point
+  // FFT as conj(FFT(conj(Z))). The conjugations are folded into the loads
+  // and stores.
+  _Alignas(64) float zr[FFT_HALF], zi[FFT_HALF];
+  {
+    float er = re[0] + re[FFT_HALF], or_ = re[0] - re[FFT_HALF];
+    zr[0] = er;
+    zi[0] = -or_;
+  }
+  for (int k = 1; k < FFT_HALF; k++) {
+    float ar = re[k], ai = im[k];
+    float br = re[FFT_HALF - k], bi = -im[FFT_HALF - k];
+    float er = ar + br, ei = ai + bi;
+    float dr = ar - br, di = ai - bi;
+    // W^-k = conj(W^k)
+    float wr = plan.split_re[k], wi = -plan.split_im[k];
+    float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+    zr[k] = er - oi;
+    zi[k] = -(ei + or_);
+  }
+
+  _Alignas(64) float Zr[FFT_HALF], Zi[FFT_HALF];
+  fft_half(zr, zi, Zr, Zi);
+
+  for (int n = 0; n < FFT_HALF; n++) {
+    out[2 * n] = Zr[n];
+    out[2 * n + 1] = -Zi[n];
+  }
+}
+
+#ifdef AUDX_RNNOISE_FFT
+#include "kiss_fft.h"
+
+// kiss_fft.c is built with its rnn_fft_c renamed to this
+void rnn_fft_c_generic(const kiss_fft_state *st, const kiss_fft_cpx *fin,
+                       kiss_fft_cpx *fout);
+
+/*
+ * Conversions between kiss_fft's interleaved spectra and the split arrays of
+ * the real FFT. They run on every frame next to the transforms themselves,
+ * so they are vectorized in 4-wide blocks of two complex values.
+ */
+
+// Deinterleave the real parts of fin into x; true if every imaginary part is
+// zero.
+static bool load_real(const kiss_fft_cpx *fin, float *x) {
+  const float *p = (const float *)fin;
+  bool real = true;
+#if FFT_WIDTH > 1
+  const vf4 zero = {0};
+  vi4 nonzero = {0};
+  for (int n = 0; n < AUDX_FFT_SIZE; n += 4) {
+    vf4 a = LD(vf4, p + 2 * n), b = LD(vf4, p + 2 * n + 4);
+    ST(vf4, x + n, __builtin_shufflevector(a, b, 0, 2, 4, 6));
+    nonzero |= __builtin_shufflevector(a, b, 1, 3, 5, 7) != zero;
+  }
+  for (int i = 0; i < 4; i++)
+    real &= nonzero[i] == 0;
+#else
+  for (int n = 0; n < AUDX_FFT_SIZE; n++) {
+    x[n] = p[2 * n];
+    real &= p[2 * n + 1] == 0.0f;
+  }
+#endif
+  return real;
+}
+
+// If fin is exactly Hermitian, load the conjugate of its first half into
+// re/im and return true.
+static bool load_hermitian(const kiss_fft_cpx *fin, float *re, float *im) {
+  if (fin[0].i != 0.0f || fin[FFT_HALF].i != 0.0f)
+    return false;
+
+  int k = 1;
+#if FFT_WIDTH > 1
+  const float *p = (const float *)fin;
+  const vf4 conj = {1.0f, -1.0f, 1.0f, -1.0f};
+  vi4 mismatch = {0};
+  for (; k + 2 <= FFT_HALF; k += 2) {
+    // X[k], X[k + 1] against X[N - k - 1], X[N - k]
+    vf4 a = LD(vf4, p + 2 * k);
+    vf4 b = LD(vf4, p + 2 * (AUDX_FFT_SIZE - k - 1));
+    mismatch |= a != __builtin_shufflevector(b, b, 2, 3, 0, 1) * conj;
+  }
+  for (int i = 0; i < 4; i++)
+    if (mismatch[i])
+      return false;
+#endif
+  for (; k < FFT_HALF; k++)
+    if (fin[k].r != fin[AUDX_FFT_SIZE - k].r ||
+        fin[k].i != -fin[AUDX_FFT_SIZE - k].i)
+      return false;
+
+  k = 0;
+#if FFT_WIDTH > 1
+  for (; k + 4 <= AUDX_FFT_BINS; k += 4) {
+    vf4 a = LD(vf4, p + 2 * k), b = LD(vf4, p + 2 * k + 4);
+    ST(vf4, re + k, __builtin_shufflevector(a, b, 0, 2, 4, 6));
+    ST(vf4, im + k, -__builtin_shufflevector(a, b, 1, 3, 5, 7));
+  }
+#endif
+  for (; k < AUDX_FFT_BINS; k++) {
+    re[k] = fin[k].r;
+    im[k] = -fin[k].i;
+  }
+  return true;
+}
+
+// Scaled full spectrum from its first half
+static void store_spectrum(kiss_fft_cpx *fout, const float *re,
+                           const float *im, float scale) {
+  int k = 0;
+#if FFT_WIDTH > 1
+  float *p = (float *)fout;
+  for (; k + 4 <= AUDX_FFT_BINS; k += 4) {
+    vf4 r = scale * LD(vf4, re + k), i = scale * LD(vf4, im + k);
+    ST(vf4, p + 2 * k, __builtin_shufflevector(r, i, 0, 4, 1, 5));
+    ST(vf4, p + 2 * k + 4, __builtin_shufflevector(r, i, 2, 6, 3, 7));
+  }
+#endif
+  for (; k < AUDX_FFT_BINS; k++) {
+    fout[k].r = scale * re[k];
+    fout[k].i = scale * im[k];
+  }
+
+  // The upper half mirrors bins 1 .. N/2 - 1, conjugated
+  k = 1;
+#if FFT_WIDTH > 1
+  const vf4 conj = {1.0f, -1.0f, 1.0f, -1.0f};
+  for (; k + 2 <= FFT_HALF; k += 2) {
+    vf4 a = LD(vf4, p + 2 * k);
+    ST(vf4, p + 2 * (AUDX_FFT_SIZE - k - 1),
+       __builtin_shufflevector(a, a, 2, 3, 0, 1) * conj);
+  }
+#endif
+  for (; k < FFT_HALF; k++) {
+    fout[AUDX_FFT_SIZE - k].r = fout[k].r;
+    fout[AUDX_FFT_SIZE - k].i = -fout[k].i;
+  }
+}
+
+// Scaled real signal as a complex one
+static void store_real(kiss_fft_cpx *fout, const float *y, float scale) {
+  int n = 0;
+#if FFT_WIDTH > 1
+  float *p = (float *)fout;
+  const vf4 zero = {0};
+  for (; n < AUDX_FFT_SIZE; n += 4) {
+    vf4 v = scale * LD(vf4, y + n);
+    ST(vf4, p + 2 * n, __builtin_shufflevector(v, zero, 0, 4, 1, 5));
+    ST(vf4, p + 2 * n + 4, __builtin_shufflevector(v, zero, 2, 6, 3, 7));
+  }
+#endif
+  for (; n < AUDX_FFT_SIZE; n++) {
+    fout[n].r = scale * y[n];
+    fout[n].i = 0.0f;
+  }
+}
+
+/**
+ * RNNoise only transforms real windows forward and Hermitian spectra for
+ * synthesis; both are checked exactly and take the real FFT. Anything else,
+ * and every other size, goes to kiss_fft.
+ */
+void rnn_fft_c(const kiss_fft_state *st, const kiss_fft_cpx *fin,
+               kiss_fft_cpx *fout) {
+  if (st->nfft != AUDX_FFT_SIZE) {
+    rnn_fft_c_generic(st, fin, fout);
+    return;
+  }
+
+  _Alignas(64) float x[AUDX_FFT_SIZE];
+  _Alignas(64) float re[AUDX_FFT_BINS], im[AUDX_FFT_BINS];
+  if (load_real(fin, x)) {
+    audx_fft_forward(x, re, im);
+    store_spectrum(fout, re, im, st->scale);
+    return;
+  }
+
+  if (load_hermitian(fin, re, im)) {
+    // The forward DFT of a Hermitian X is real and equals the inverse DFT
+    // of conj(X).
+    audx_fft_inverse(re, im, x);
+    store_real(fout, x, st->scale);
+    return;
+  }
+
+  rnn_fft_c_generic(st, fin, fout);
+}
+#endif // AUDX_RNNOISE_FFT
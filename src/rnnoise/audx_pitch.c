@@ -0,0 +1,333 @@
+/*
+ * Pitch analysis for RNNoise, replacing its pitch.c when AUDX_RNNOISE_PITCH
+ * is on. The algorithms are the float paths of the CELT code RNNoise ships;
+ * only the correlation, autocorrelation and filter loops are rewritten as
+ * vector kernels. Sums are reassociated, so results match the scalar code to
+ * rounding rather than bit for bit.
+ */
+
+#include "audx_simd.h"
+#include "celt_lpc.h"
+#include "pitch.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define W AUDX_SIMD_WIDTH
+
+// Bandwidth expansion and added zero of the pitch downsampling filter
+#define LPC_ORDER 4
+#define LPC_ZERO 0.8f
+
+static inline float inner_prod(const float *x, const float *y, int n) {
+  int i = 0;
+  float sum = 0.0f;
+#if W > 1
+  // Two accumulators hide the add latency
+  vf acc0 = {0}, acc1 = {0};
+  for (; i + 2 * W <= n; i += 2 * W) {
+    acc0 += LD(vf, x + i) * LD(vf, y + i);
+    acc1 += LD(vf, x + i + W) * LD(vf, y + i + W);
+  }
+  if (i + W <= n) {
+    acc0 += LD(vf, x + i) * LD(vf, y + i);
+    i += W;
+  }
+  sum = vf_sum(acc0 + acc1);
+#endif
+  for (; i < n; i++)
+    sum += x[i] * y[i];
+  return sum;
+}
+
+// x . y1 and x . y2 in one pass over x
+static inline void inner_prod2(const float *x, const float *y1,
+                               const float *y2, int n, float *xy1,
+                               float *xy2) {
+  int i = 0;
+  float sum1 = 0.0f, sum2 = 0.0f;
+#if W > 1
+  vf acc1 = {0}, acc2 = {0};
+  for (; i + W <= n; i += W) {
+    vf xv = LD(vf, x + i);
+    acc1 += xv * LD(vf, y1 + i);
+    acc2 += xv * LD(vf, y2 + i);
+  }
+  sum1 = vf_sum(acc1);
+  sum2 = vf_sum(acc2);
+#endif
+  for (; i < n; i++) {
+    sum1 += x[i] * y1[i];
+    sum2 += x[i] * y2[i];
+  }
+  *xy1 = sum1;
+  *xy2 = sum2;
+}
+
+void celt_pitch_xcorr(const opus_val16 *_x, const opus_val16 *_y,
+                      opus_val32 *xcorr, int len, int max_pitch) {
+  int i = 0;
+#if W > 1
+  // W lags per register: each x[j] is broadcast against y[i + j ...]
+  for (; i + W <= max_pitch; i += W) {
+    vf acc0 = {0}, acc1 = {0};
+    int j = 0;
+    for (; j + 1 < len; j += 2) {
+      acc0 += _x[j] * LD(vf, _y + i + j);
+      acc1 += _x[j + 1] * LD(vf, _y + i + j + 1);
+    }
+    if (j < len)
+      acc0 += _x[j] * LD(vf, _y + i + j);
+    ST(vf, xcorr + i, acc0 + acc1);
+  }
+#endif
+  // Leftover lags, and short lag ranges such as the LPC autocorrelation,
+  // vectorize along the signal instead.
+  for (; i < max_pitch; i++)
+    xcorr[i] = inner_prod(_x, _y + i, len);
+}
+
+static void find_best_pitch(const opus_val32 *xcorr, const opus_val16 *y,
+                            int len, int max_pitch, int *best_pitch) {
+  float Syy = 1.0f + inner_prod(y, y, len);
+  float best_num[2] = {-1.0f, -1.0f};
+  float best_den[2] = {0.0f, 0.0f};
+  best_pitch[0] = 0;
+  best_pitch[1] = 1;
+
+  for (int i = 0; i < max_pitch; i++) {
+    if (xcorr[i] > 0.0f) {
+      // Scale down to avoid overflow in the square
+      float xcorr16 = xcorr[i] * 1e-12f;
+      float num = xcorr16 * xcorr16;
+      if (num * best_den[1] > best_num[1] * Syy) {
+        if (num * best_den[0] > best_num[0] * Syy) {
+          best_num[1] = best_num[0];
+          best_den[1] = best_den[0];
+          best_pitch[1] = best_pitch[0];
+          best_num[0] = num;
+          best_den[0] = Syy;
+          best_pitch[0] = i;
+        } else {
+          best_num[1] = num;
+          best_den[1] = Syy;
+          best_pitch[1] = i;
+        }
+      }
+    }
+    Syy += y[i + len] * y[i + len] - y[i] * y[i];
+    Syy = fmaxf(1.0f, Syy);
+  }
+}
+
+/**
+ * In-place FIR y[i] = x[i] + sum num[k] x[i - k - 1] with zero history.
+ * Blocks are filtered from the end so every input they read is still
+ * unmodified.
+ */
+static void fir5_inplace(float *x, const float num[5], int n) {
+  int i = n;
+#if W > 1
+  for (; i - W >= 5; i -= W) {
+    float *p = x + i - W;
+    vf sum = LD(vf, p);
+    sum += num[0] * LD(vf, p - 1);
+    sum += num[1] * LD(vf, p - 2);
+    sum += num[2] * LD(vf, p - 3);
+    sum += num[3] * LD(vf, p - 4);
+    sum += num[4] * LD(vf, p - 5);
+    ST(vf, p, sum);
+  }
+#endif
+  while (i-- > 0) {
+    float sum = x[i];
+    for (int k = 0; k < 5 && k < i; k++)
+      sum += num[k] * x[i - k - 1];
+    x[i] = sum;
+  }
+}
+
+static inline float downsample_at(const celt_sig *x, int i) {
+  if (i == 0)
+    return 0.5f * (0.5f * x[1] + x[0]);
+  return 0.5f * (0.5f * (x[2 * i - 1] + x[2 * i + 1]) + x[2 * i]);
+}
+
+void pitch_downsample(celt_sig *x[], opus_val16 *x_lp, int len, int C) {
+  const int n = len >> 1;
+  for (int i = 0; i < n; i++)
+    x_lp[i] = downsample_at(x[0], i);
+  if (C == 2) {
+    for (int i = 0; i < n; i++)
+      x_lp[i] += downsample_at(x[1], i);
+  }
+
+  float ac[LPC_ORDER + 1];
+  for (int k = 0; k <= LPC_ORDER; k++)
+    ac[k] = inner_prod(x_lp, x_lp + k, n - k);
+
+  // Noise floor -40 dB
+  ac[0] *= 1.0001f;
+  // Lag windowing
+  for (int k = 1; k <= LPC_ORDER; k++)
+    ac[k] -= ac[k] * (0.008f * k) * (0.008f * k);
+
+  float lpc[LPC_ORDER];
+  _celt_lpc(lpc, ac, LPC_ORDER);
+  float tmp = 1.0f;
+  for (int k = 0; k < LPC_ORDER; k++) {
+    tmp *= 0.9f;
+    lpc[k] *= tmp;
+  }
+
+  // Add a zero
+  float lpc2[LPC_ORDER + 1];
+  lpc2[0] = lpc[0] + LPC_ZERO;
+  lpc2[1] = lpc[1] + LPC_ZERO * lpc[0];
+  lpc2[2] = lpc[2] + LPC_ZERO * lpc[1];
+  lpc2[3] = lpc[3] + LPC_ZERO * lpc[2];
+  lpc2[4] = LPC_ZERO * lpc[3];
+  fir5_inplace(x_lp, lpc2, n);
+}
+
+void pitch_search(const opus_val16 *x_lp, opus_val16 *y, int len,
+                  int max_pitch, int *pitch) {
+  const int lag = len + max_pitch;
+  int best_pitch[2] = {0, 0};
+
+  float x_lp4[len >> 2];
+  float y_lp4[lag >> 2];
+  float xcorr[max_pitch >> 1];
+
+  // Downsample by 2 again
+  for (int j = 0; j < len >> 2; j++)
+    x_lp4[j] = x_lp[2 * j];
+  for (int j = 0; j < lag >> 2; j++)
+    y_lp4[j] = y[2 * j];
+
+  // Coarse search with 4x decimation
+  celt_pitch_xcorr(x_lp4, y_lp4, xcorr, len >> 2, max_pitch >> 2);
+  find_best_pitch(xcorr, y_lp4, len >> 2, max_pitch >> 2, best_pitch);
+
+  // Finer search with 2x decimation around the two coarse candidates
+  for (int i = 0; i < max_pitch >> 1; i++) {
+    xcorr[i] = 0.0f;
+    if (abs(i - 2 * best_pitch[0]) > 2 && abs(i - 2 * best_pitch[1]) > 2)
+      continue;
+    xcorr[i] = fmaxf(-1.0f, inner_prod(x_lp, y + i, len >> 1));
+  }
+  find_best_pitch(xcorr, y, len >> 1, max_pitch >> 1, best_pitch);
+
+  // Refine by pseudo-interpolation
+  int offset = 0;
+  if (best_pitch[0] > 0 && best_pitch[0] < (max_pitch >> 1) - 1) {
+    float a = xcorr[best_pitch[0] - 1];
+    float b = xcorr[best_pitch[0]];
+    float c = xcorr[best_pitch[0] + 1];
+    if (c - a > 0.7f * (b - a))
+      offset = 1;
+    else if (a - c > 0.7f * (b - c))
+      offset = -1;
+  }
+  *pitch = 2 * best_pitch[0] - offset;
+}
+
+static inline float compute_pitch_gain(float xy, float xx, float yy) {
+  return xy / sqrtf(1.0f + xx * yy);
+}
+
+static const int second_check[16] = {0, 0, 3, 2, 3, 2, 5, 2,
+                                     3, 2, 3, 2, 5, 2, 3, 2};
+
+opus_val16 remove_doubling(opus_val16 *x, int maxperiod, int minperiod,
+                           int N, int *T0_, int prev_period,
+                           opus_val16 prev_gain) {
+  const int minperiod0 = minperiod;
+  maxperiod /= 2;
+  minperiod /= 2;
+  *T0_ /= 2;
+  prev_period /= 2;
+  N /= 2;
+  x += maxperiod;
+  if (*T0_ >= maxperiod)
+    *T0_ = maxperiod - 1;
+
+  int T = *T0_;
+  const int T0 = *T0_;
+  float xx, xy, yy, xy2;
+  float yy_lookup[maxperiod + 1];
+
+  inner_prod2(x, x, x - T0, N, &xx, &xy);
+  yy_lookup[0] = xx;
+  yy = xx;
+  for (int i = 1; i <= maxperiod; i++) {
+    yy = yy + x[-i] * x[-i] - x[N - i] * x[N - i];
+    yy_lookup[i] = fmaxf(0.0f, yy);
+  }
+  yy = yy_lookup[T0];
+  float best_xy = xy;
+  float best_yy = yy;
+  const float g0 = compute_pitch_gain(xy, xx, yy);
+  float g = g0;
+
+  // Look for any pitch at T/k
+  for (int k = 2; k <= 15; k++) {
+    int T1 = (2 * T0 + k) / (2 * k);
+    if (T1 < minperiod)
+      break;
+
+    // Look for another strong correlation at T1b
+    int T1b;
+    if (k == 2)
+      T1b = T1 + T0 > maxperiod ? T0 : T0 + T1;
+    else
+      T1b = (2 * second_check[k] * T0 + k) / (2 * k);
+
+    inner_prod2(x, &x[-T1], &x[-T1b], N, &xy, &xy2);
+    xy = 0.5f * (xy + xy2);
+    yy = 0.5f * (yy_lookup[T1] + yy_lookup[T1b]);
+    float g1 = compute_pitch_gain(xy, xx, yy);
+
+    float cont;
+    if (abs(T1 - prev_period) <= 1)
+      cont = prev_gain;
+    else if (abs(T1 - prev_period) <= 2 && 5 * k * k < T0)
+      cont = 0.5f * prev_gain;
+    else
+      cont = 0.0f;
+
+    float thresh = fmaxf(0.3f, 0.7f * g0 - cont);
+    // Bias against very high pitch (very short period) to avoid
+    // false-positives due to short-term correlation
+    if (T1 < 3 * minperiod)
+      thresh = fmaxf(0.4f, 0.85f * g0 - cont);
+    else if (T1 < 2 * minperiod)
+      thresh = fmaxf(0.5f, 0.9f * g0 - cont);
+
+    if (g1 > thresh) {
+      best_xy = xy;
+      best_yy = yy;
+      T = T1;
+      g = g1;
+    }
+  }
+
+  best_xy = fmaxf(0.0f, best_xy);
+  float pg = best_yy <= best_xy ? 1.0f : best_xy / (best_yy + 1.0f);
+
+  float xcorr[3];
+  for (int k = 0; k < 3; k++)
+    xcorr[k] = inner_prod(x, x - (T + k - 1), N);
+
+  int offset = 0;
+  if (xcorr[2] - xcorr[0] > 0.7f * (xcorr[1] - xcorr[0]))
+    offset = 1;
+  else if (xcorr[0] - xcorr[2] > 0.7f * (xcorr[1] - xcorr[2]))
+    offset = -1;
+
+  if (pg > g)
+    pg = g;
+  *T0_ = 2 * T + offset;
+  if (*T0_ < minperiod0)
+    *T0_ = minperiod0;
+  return pg;
+}
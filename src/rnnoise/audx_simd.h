@@ -0,0 +1,41 @@
+#ifndef AUDX_RNNOISE_SIMD_H
+#define AUDX_RNNOISE_SIMD_H
+
+/*
+ * Vector types for the kernels built into the rnnoise target.
+ *
+ * Kernels are written once against GCC vector types and compiled to the
+ * widest registers the target has (AVX-512, AVX2, SSE or NEON). The width is
+ * fixed at compile time; desktop builds of rnnoise use -march=native.
+ */
+
+#if defined(__AVX512F__)
+#define AUDX_SIMD_WIDTH 16
+#elif defined(__AVX__)
+#define AUDX_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define AUDX_SIMD_WIDTH 4
+#else
+#define AUDX_SIMD_WIDTH 1
+#endif
+
+// Unaligned load/store of type T, a vector type or float
+#define LD(T, ptr) (*(const T *)(ptr))
+#define ST(T, ptr, v) (*(T *)(ptr) = (v))
+
+#if AUDX_SIMD_WIDTH > 1
+typedef float vf __attribute__((vector_size(AUDX_SIMD_WIDTH * sizeof(float)),
+                                aligned(sizeof(float)), may_alias));
+typedef float vf4 __attribute__((vector_size(4 * sizeof(float)),
+                                 aligned(sizeof(float)), may_alias));
+typedef int vi4 __attribute__((vector_size(4 * sizeof(int))));
+
+static inline float vf_sum(vf v) {
+  float sum = 0.0f;
+  for (int i = 0; i < AUDX_SIMD_WIDTH; i++)
+    sum += v[i];
+  return sum;
+}
+#endif
+
+#endif // AUDX_RNNOISE_SIMD_H
@@ -0,0 +1,630 @@
+#include "audx_pcap.h"
+#include "audx.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PCAP_MAGIC_US 0xa1b2c3d4u
+#define PCAP_MAGIC_NS 0xa1b23c4du
+#define PCAPNG_SHB 0x0a0d0d0au
+#define PCAPNG_IDB 0x00000001u
+#define PCAPNG_OPB 0x00000002u
+#define PCAPNG_SPB 0x00000003u
+#define PCAPNG_EPB 0x00000006u
+#define PCAPNG_BYTE_ORDER 0x1a2b3c4du
+#define PCAPNG_MAX_INTERFACES 64
+
+#define LINKTYPE_NULL 0
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_RAW 101
+#define LINKTYPE_LOOP 108
+#define LINKTYPE_LINUX_SLL 113
+#define LINKTYPE_IPV4 228
+#define LINKTYPE_IPV6 229
+#define LINKTYPE_LINUX_SLL2 276
+
+// Larger records are corrupt for our purposes; RTP never comes close.
+#define PCAP_MAX_RECORD (256u * 1024u)
+
+#define RTP_PT_PCMU 0
+#define RTP_PT_PCMA 8
+#define RTP_RATE 8000u
+// Timestamp jumps beyond this are treated as a stream restart, not a gap.
+#define RTP_MAX_GAP_SAMPLES (RTP_RATE * 60u)
+// This many late packets in a row, in sequence, mean the sequence jumped,
+// e.g. on a sender restart, rather than reordering.
+#define RTP_RESYNC_PACKETS 3
+
+typedef struct PcapReader {
+  FILE *file;
+  bool ng;
+  bool swapped;
+  uint32_t linktype; // Classic pcap only
+  uint32_t ng_linktypes[PCAPNG_MAX_INTERFACES];
+  unsigned int ng_interfaces;
+  uint8_t *buf;
+  size_t cap;
+} PcapReader;
+
+typedef struct RtpStream {
+  uint32_t ssrc;
+  uint8_t payload_type;
+  uint16_t next_seq;
+  uint32_t next_ts;
+  short *pcm;
+  size_t samples;
+  size_t capacity;
+  size_t packets;
+  size_t lost;
+  size_t late;
+  size_t late_run;   // Consecutive late packets in sequence
+  uint16_t late_seq; // Sequence number that continues the run
+  size_t filled;     // Silence samples inserted
+  // Filled in by the worker
+  size_t frames;
+  double vad_sum;
+  bool failed;
+} RtpStream;
+
+typedef struct RtpStreams {
+  RtpStream *items;
+  size_t count;
+  size_t capacity;
+} RtpStreams;
+
+typedef struct PcapJob {
+  RtpStreams *streams;
+  const char *out_dir;
+  atomic_size_t next;
+} PcapJob;
+
+static uint16_t be16(const uint8_t *p) { return (uint16_t)(p[0] << 8 | p[1]); }
+
+static uint32_t be32(const uint8_t *p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 |
+         p[3];
+}
+
+static uint32_t file32(const PcapReader *r, const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return r->swapped ? __builtin_bswap32(v) : v;
+}
+
+static uint16_t file16(const PcapReader *r, const uint8_t *p) {
+  uint16_t v;
+  memcpy(&v, p, sizeof(v));
+  return r->swapped ? __builtin_bswap16(v) : v;
+}
+
+static bool reserve(PcapReader *r, size_t len) {
+  if (len <= r->cap)
+    return true;
+  uint8_t *grown = realloc(r->buf, len);
+  if (!grown)
+    return false;
+  r->buf = grown;
+  r->cap = len;
+  return true;
+}
+
+static int pcap_open(PcapReader *r, const char *path) {
+  memset(r, 0, sizeof(*r));
+  r->file = fopen(path, "rb");
+  if (!r->file)
+    return -1;
+
+  uint8_t header[24];
+  if (fread(header, 1, 4, r->file) != 4)
+    return -1;
+
+  uint32_t magic;
+  memcpy(&magic, header, 4);
+  if (magic == PCAPNG_SHB) {
+    // Sections are parsed as blocks; rewind so the SHB is read like any other.
+    r->ng = true;
+    return fseek(r->file, 0, SEEK_SET);
+  }
+
+  if (fread(header + 4, 1, 20, r->file) != 20)
+    return -1;
+  if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS)
+    r->swapped = false;
+  else if (__builtin_bswap32(magic) == PCAP_MAGIC_US ||
+           __builtin_bswap32(magic) == PCAP_MAGIC_NS)
+    r->swapped = true;
+  else
+    return -1;
+
+  // The upper bits of the link type field carry FCS information
+  r->linktype = file32(r, header + 20) & 0x0fffffff;
+  return 0;
+}
+
+static void pcap_close(PcapReader *r) {
+  if (r->file)
+    fclose(r->file);
+  free(r->buf);
+}
+
+static int pcap_next_classic(PcapReader *r, const uint8_t **data,
+                             uint32_t *len, uint32_t *linktype) {
+  uint8_t header[16];
+  if (fread(header, 1, sizeof(header), r->file) != sizeof(header))
+    return 0;
+
+  uint32_t incl_len = file32(r, header + 8);
+  if (incl_len > PCAP_MAX_RECORD || !reserve(r, incl_len) ||
+      fread(r->buf, 1, incl_len, r->file) != incl_len)
+    return -1;
+
+  *data = r->buf;
+  *len = incl_len;
+  *linktype = r->linktype;
+  return 1;
+}
+
+static int pcap_next_ng(PcapReader *r, const uint8_t **data, uint32_t *len,
+                        uint32_t *linktype) {
+  for (;;) {
+    uint8_t header[8];
+    if (fread(header, 1, sizeof(header), r->file) != sizeof(header))
+      return 0;
+
+    uint32_t type;
+    memcpy(&type, header, 4);
+    if (type == PCAPNG_SHB) {
+      // A new section may switch byte order and resets the interfaces.
+      uint8_t bom[4];
+      if (fread(bom, 1, 4, r->file) != 4)
+        return -1;
+      uint32_t order;
+      memcpy(&order, bom, 4);
+      if (order == PCAPNG_BYTE_ORDER)
+        r->swapped = false;
+      else if (__builtin_bswap32(order) == PCAPNG_BYTE_ORDER)
+        r->swapped = true;
+      else
+        return -1;
+      r->ng_interfaces = 0;
+
+      uint32_t total = file32(r, header + 4);
+      if (total < 28 || total % 4 ||
+          fseek(r->file, (long)total - 12, SEEK_CUR) != 0)
+        return -1;
+      continue;
+    }
+
+    type = file32(r, header);
+    uint32_t total = file32(r, header + 4);
+    if (total < 12 || total % 4 || total > PCAP_MAX_RECORD)
+      return -1;
+
+    uint32_t body_len = total - 8;
+    if (!reserve(r, body_len) ||
+        fread(r->buf, 1, body_len, r->file) != body_len)
+      return -1;
+    const uint8_t *body = r->buf;
+    body_len -= 4; // Trailing copy of the block length
+
+    uint32_t interface = 0;
+    uint32_t cap_len = 0;
+    const uint8_t *packet = NULL;
+    switch (type) {
+    case PCAPNG_IDB:
+      if (body_len >= 8 && r->ng_interfaces < PCAPNG_MAX_INTERFACES)
+        r->ng_linktypes[r->ng_interfaces++] = file16(r, body);
+      continue;
+    case PCAPNG_EPB:
+      if (body_len < 20)
+        return -1;
+      interface = file32(r, body);
+      cap_len = file32(r, body + 12);
+      packet = body + 20;
+      if (cap_len > body_len - 20)
+        return -1;
+      break;
+    case PCAPNG_OPB:
+      if (body_len < 20)
+        return -1;
+      interface = file16(r, body);
+      cap_len = file32(r, body + 12);
+      packet = body + 20;
+      if (cap_len > body_len - 20)
+        return -1;
+      break;
+    case PCAPNG_SPB:
+      if (body_len < 4)
+        return -1;
+      cap_len = file32(r, body);
+      packet = body + 4;
+      if (cap_len > body_len - 4)
+        cap_len = body_len - 4;
+      break;
+    default:
+      continue; // Statistics, name resolution, custom blocks
+    }
+
+    if (interface >= r->ng_interfaces)
+      continue;
+    *data = packet;
+    *len = cap_len;
+    *linktype = r->ng_linktypes[interface];
+    return 1;
+  }
+}
+
+/**
+ * Read the next packet. Returns 1 on success, 0 at end of file and -1 on a
+ * malformed file.
+ */
+static int pcap_next(PcapReader *r, const uint8_t **data, uint32_t *len,
+                     uint32_t *linktype) {
+  return r->ng ? pcap_next_ng(r, data, len, linktype)
+               : pcap_next_classic(r, data, len, linktype);
+}
+
+/**
+ * Strip link, IP and UDP headers. Returns the UDP payload, or NULL for
+ * anything that is not an unfragmented UDP datagram.
+ */
+static const uint8_t *udp_payload(uint32_t linktype, const uint8_t *p,
+                                  uint32_t len, uint32_t *out_len) {
+  switch (linktype) {
+  case LINKTYPE_ETHERNET: {
+    if (len < 14)
+      return NULL;
+    uint32_t off = 12;
+    uint16_t ethertype = be16(p + off);
+    while ((ethertype == 0x8100 || ethertype == 0x88a8) && len >= off + 6) {
+      off += 4; // VLAN tag
+      ethertype = be16(p + off);
+    }
+    if (ethertype != 0x0800 && ethertype != 0x86dd)
+      return NULL;
+    p += off + 2;
+    len -= off + 2;
+    break;
+  }
+  case LINKTYPE_LINUX_SLL:
+    if (len < 16)
+      return NULL;
+    p += 16;
+    len -= 16;
+    break;
+  case LINKTYPE_LINUX_SLL2:
+    if (len < 20)
+      return NULL;
+    p += 20;
+    len -= 20;
+    break;
+  case LINKTYPE_NULL:
+  case LINKTYPE_LOOP:
+    if (len < 4)
+      return NULL;
+    p += 4;
+    len -= 4;
+    break;
+  case LINKTYPE_RAW:
+  case LINKTYPE_IPV4:
+  case LINKTYPE_IPV6:
+    break;
+  default:
+    return NULL;
+  }
+
+  // The IP version nibble decides, whatever the link layer claimed.
+  if (len < 1)
+    return NULL;
+  if ((p[0] >> 4) == 4) {
+    uint32_t ihl = (p[0] & 0x0f) * 4u;
+    if (len < 20 || ihl < 20 || len < ihl || p[9] != 17)
+      return NULL;
+    if (be16(p + 6) & 0x3fff) // More fragments or non-zero offset
+      return NULL;
+    uint32_t total = be16(p + 2);
+    if (total >= ihl && total < len)
+      len = total;
+    p += ihl;
+    len -= ihl;
+  } else if ((p[0] >> 4) == 6) {
+    if (len < 40 || p[6] != 17)
+      return NULL;
+    uint32_t payload = be16(p + 4);
+    p += 40;
+    len -= 40;
+    if (payload < len)
+      len = payload;
+  } else {
+    return NULL;
+  }
+
+  if (len < 8)
+    return NULL;
+  uint32_t udp_len = be16(p + 4);
+  if (udp_len >= 8 && udp_len < len)
+    len = udp_len;
+  *out_len = len - 8;
+  return p + 8;
+}
+
+static short ulaw_decode(uint8_t u) {
+  u = ~u;
+  int t = ((u & 0x0f) << 3) + 0x84;
+  t <<= (u & 0x70) >> 4;
+  return (short)((u & 0x80) ? (0x84 - t) : (t - 0x84));
+}
+
+static short alaw_decode(uint8_t a) {
+  a ^= 0x55;
+  int t = (a & 0x0f) << 4;
+  int seg = (a & 0x70) >> 4;
+  if (seg == 0)
+    t += 8;
+  else if (seg == 1)
+    t += 0x108;
+  else
+    t = (t + 0x108) << (seg - 1);
+  return (short)((a & 0x80) ? t : -t);
+}
+
+static RtpStream *find_stream(RtpStreams *streams, uint32_t ssrc) {
+  for (size_t i = 0; i < streams->count; i++)
+    if (streams->items[i].ssrc == ssrc)
+      return &streams->items[i];
+
+  if (streams->count == streams->capacity) {
+    size_t capacity = streams->capacity ? streams->capacity * 2 : 16;
+    RtpStream *grown =
+        realloc(streams->items, capacity * sizeof(RtpStream));
+    if (!grown)
+      return NULL;
+    streams->items = grown;
+    streams->capacity = capacity;
+  }
+
+  RtpStream *stream = &streams->items[streams->count++];
+  memset(stream, 0, sizeof(*stream));
+  stream->ssrc = ssrc;
+  return stream;
+}
+
+static bool append_pcm(RtpStream *stream, size_t samples) {
+  size_t needed = stream->samples + samples;
+  if (needed <= stream->capacity)
+    return true;
+
+  size_t capacity = stream->capacity ? stream->capacity : RTP_RATE;
+  while (capacity < needed)
+    capacity *= 2;
+  short *grown = realloc(stream->pcm, capacity * sizeof(short));
+  if (!grown)
+    return false;
+  stream->pcm = grown;
+  stream->capacity = capacity;
+  return true;
+}
+
+/**
+ * Add one RTP packet to its stream. Sequence numbers detect loss and late
+ * packets; timestamps decide how much silence replaces missing audio, which
+ * also covers silence suppression. Late packets are dropped, unless several
+ * come in a row, in which case the stream resyncs to their sequence.
+ */
+static bool add_rtp(RtpStreams *streams, const uint8_t *p, uint32_t len) {
+  if (len < 12 || (p[0] >> 6) != 2)
+    return true;
+
+  uint8_t pt = p[1] & 0x7f;
+  if (pt != RTP_PT_PCMU && pt != RTP_PT_PCMA)
+    return true;
+
+  uint32_t header = 12 + (p[0] & 0x0f) * 4u;
+  if ((p[0] & 0x10) && len >= header + 4)
+    header += 4 + be16(p + header + 2) * 4u;
+  if ((p[0] & 0x20) && len > header)
+    len -= p[len - 1] < len - header ? p[len - 1] : len - header;
+  if (len <= header)
+    return true;
+
+  uint16_t seq = be16(p + 2);
+  uint32_t ts = be32(p + 4);
+  RtpStream *stream = find_stream(streams, be32(p + 8));
+  if (!stream)
+    return false;
+
+  if (stream->packets == 0) {
+    stream->payload_type = pt;
+  } else {
+    int16_t seq_delta = (int16_t)(seq - stream->next_seq);
+    if (seq_delta < 0) {
+      stream->late_run =
+          stream->late_run && seq == stream->late_seq ? stream->late_run + 1
+                                                      : 1;
+      stream->late_seq = seq + 1;
+      if (stream->late_run < RTP_RESYNC_PACKETS) {
+        stream->late++;
+        return true;
+      }
+      // The packets dropped before the resync were lost, not late.
+      fprintf(stderr, "SSRC %08x: sequence jumped to %u, resyncing\n",
+              stream->ssrc, seq);
+      stream->late -= stream->late_run - 1;
+      stream->lost += stream->late_run - 1;
+      stream->next_seq = seq;
+      stream->next_ts = ts;
+      seq_delta = 0;
+    }
+    stream->late_run = 0;
+    stream->lost += (size_t)seq_delta;
+
+    uint32_t gap = ts - stream->next_ts;
+    if (gap > 0 && gap <= RTP_MAX_GAP_SAMPLES) {
+      if (!append_pcm(stream, gap))
+        return false;
+      memset(stream->pcm + stream->samples, 0, gap * sizeof(short));
+      stream->samples += gap;
+      stream->filled += gap;
+    }
+  }
+
+  uint32_t payload = len - header;
+  if (!append_pcm(stream, payload))
+    return false;
+  short *out = stream->pcm + stream->samples;
+  for (uint32_t i = 0; i < payload; i++)
+    out[i] = stream->payload_type == RTP_PT_PCMU ? ulaw_decode(p[header + i])
+                                                 : alaw_decode(p[header + i]);
+  stream->samples += payload;
+
+  stream->packets++;
+  stream->next_seq = seq + 1;
+  stream->next_ts = ts + payload; // G.711 carries one sample per byte
+  return true;
+}
+
+static void denoise_stream(RtpStream *stream, const char *out_dir) {
+  char path[4096];
+  snprintf(path, sizeof(path), "%s/%08x.pcm", out_dir, stream->ssrc);
+  FILE *out = fopen(path, "wb");
+  AudxState *state = audx_create(NULL, RTP_RATE, 4);
+  if (!out || !state) {
+    stream->failed = true;
+    if (out)
+      fclose(out);
+    audx_destroy(state);
+    return;
+  }
+
+  // Frames are pushed until the delayed output covers the whole stream,
+  // and the first delay samples of output are dropped.
+  const size_t delay = audx_latency(state);
+  const size_t total = stream->samples + delay;
+  unsigned int in_len = calculate_frame_sample(RTP_RATE);
+  short in[in_len];
+  short frame_out[in_len];
+  for (size_t pos = 0; pos < total; pos += in_len) {
+    size_t n = pos < stream->samples ? stream->samples - pos : 0;
+    if (n > in_len)
+      n = in_len;
+    if (n)
+      memcpy(in, stream->pcm + pos, n * sizeof(short));
+    memset(in + n, 0, (in_len - n) * sizeof(short));
+
+    float vad = audx_process_int(state, in, frame_out);
+    if (vad < 0.0f) {
+      stream->failed = true;
+      break;
+    }
+    stream->vad_sum += vad;
+    stream->frames++;
+
+    // Output sample i of this frame is input sample pos + i - delay.
+    size_t skip = pos < delay ? delay - pos : 0;
+    if (skip >= in_len)
+      continue;
+    size_t count = in_len - skip;
+    if (pos + in_len > total)
+      count = total - pos - skip;
+    if (fwrite(frame_out + skip, sizeof(short), count, out) != count) {
+      stream->failed = true;
+      break;
+    }
+  }
+
+  audx_destroy(state);
+  if (fclose(out) != 0)
+    stream->failed = true;
+}
+
+static void *worker_main(void *arg) {
+  PcapJob *job = arg;
+  for (;;) {
+    size_t i = atomic_fetch_add(&job->next, 1);
+    if (i >= job->streams->count)
+      return NULL;
+    denoise_stream(&job->streams->items[i], job->out_dir);
+  }
+}
+
+int audx_pcap_main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: audx --pcap <capture.pcap|pcapng> <output dir>\n");
+    return 1;
+  }
+  const char *out_dir = argv[1];
+  if (mkdir(out_dir, 0755) != 0 && errno != EEXIST) {
+    fprintf(stderr, "Cannot create %s\n", out_dir);
+    return 1;
+  }
+
+  PcapReader reader;
+  if (pcap_open(&reader, argv[0]) != 0) {
+    fprintf(stderr, "%s is not a readable pcap or pcapng file\n", argv[0]);
+    pcap_close(&reader);
+    return 1;
+  }
+
+  RtpStreams streams = {0};
+  const uint8_t *packet;
+  uint32_t len, linktype;
+  int ret;
+  while ((ret = pcap_next(&reader, &packet, &len, &linktype)) > 0) {
+    uint32_t udp_len;
+    const uint8_t *udp = udp_payload(linktype, packet, len, &udp_len);
+    if (udp && !add_rtp(&streams, udp, udp_len)) {
+      fprintf(stderr, "Out of memory\n");
+      ret = -1;
+      break;
+    }
+  }
+  pcap_close(&reader);
+  if (ret < 0)
+    fprintf(stderr, "Stopped at a malformed record, processing what was "
+                    "read\n");
+
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t threads = cpus > 0 ? (size_t)cpus : 1;
+  if (threads > streams.count)
+    threads = streams.count;
+
+  PcapJob job = {.streams = &streams, .out_dir = out_dir};
+  atomic_init(&job.next, 0);
+  pthread_t workers[threads ? threads : 1];
+  size_t started = 0;
+  for (; started < threads; started++)
+    if (pthread_create(&workers[started], NULL, worker_main, &job) != 0)
+      break;
+  if (started == 0)
+    worker_main(&job);
+  for (size_t i = 0; i < started; i++)
+    pthread_join(workers[i], NULL);
+
+  int status = 0;
+  printf("%10s %5s %8s %6s %6s %8s %8s %6s\n", "ssrc", "codec", "packets",
+         "lost", "late", "fill_ms", "seconds", "vad");
+  for (size_t i = 0; i < streams.count; i++) {
+    RtpStream *s = &streams.items[i];
+    printf("  %08x %5s %8zu %6zu %6zu %8zu %8.1f %6.3f%s\n", s->ssrc,
+           s->payload_type == RTP_PT_PCMU ? "PCMU" : "PCMA", s->packets,
+           s->lost, s->late, s->filled * 1000 / RTP_RATE,
+           (double)s->samples / RTP_RATE,
+           s->frames ? s->vad_sum / s->frames : 0.0,
+           s->failed ? "  FAILED" : "");
+    if (s->failed)
+      status = 1;
+    free(s->pcm);
+  }
+  if (streams.count == 0)
+    printf("No G.711 RTP streams found\n");
+
+  free(streams.items);
+  return status;
+}
@@ -0,0 +1,20 @@
+#ifndef AUDX_PCAP_H
+#define AUDX_PCAP_H
+
+/*
+ * Offline RTP ingestion for the audx CLI.
+ *
+ * Reads a pcap or pcapng file, demultiplexes RTP streams carrying G.711
+ * (payload type 0 or 8) by SSRC, fills sequence and timestamp gaps with
+ * silence, and denoises every stream through its own AudxState at 8 kHz.
+ * Streams are processed in parallel and each is written as raw 16-bit PCM
+ * to <output dir>/<ssrc>.pcm.
+ *
+ * @param argc   Argument count, excluding the mode flag.
+ * @param argv   <capture file> <output dir>
+ *
+ * @return Process exit status.
+ */
+int audx_pcap_main(int argc, char **argv);
+
+#endif // AUDX_PCAP_H
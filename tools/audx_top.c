@@ -0,0 +1,203 @@
+#include "audx_telemetry.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * audx-top: poll the telemetry segment of a running process.
+ *
+ * Reads every stream slot with the seqlock protocol and prints per-stream
+ * rates computed from the difference between two snapshots. Never writes to
+ * the segment, so audio threads are unaffected.
+ */
+
+// A writer that died mid-update leaves its slot's sequence odd for good, so
+// reads give up after this many tries and show the slot as stale.
+#define SLOT_READ_TRIES 1000
+
+typedef struct Snapshot {
+  bool live;
+  uint64_t stream_id;
+  uint32_t in_rate;
+  uint64_t frames;
+  uint64_t skipped;
+  uint64_t deadline_misses;
+  double vad_sum;
+  uint64_t stage_hist[AUDX_TELEMETRY_STAGES][AUDX_TELEMETRY_HIST_BUCKETS];
+} Snapshot;
+
+static const char *stage_names[AUDX_TELEMETRY_STAGES] = {
+    "frame", "conv_in", "upsmpl", "denoise", "dnsmpl", "conv_out",
+};
+
+static bool read_slot(AudxTelemetryStream *slot, Snapshot *snap) {
+  for (int tries = 0; tries < SLOT_READ_TRIES; tries++) {
+    unsigned int s1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (s1 & 1) {
+      // Let a preempted writer finish
+      sched_yield();
+      continue;
+    }
+
+    snap->live = atomic_load_explicit(&slot->in_use, memory_order_relaxed);
+    snap->stream_id = slot->stream_id;
+    snap->in_rate = slot->in_rate;
+    snap->frames = slot->frames;
+    snap->skipped = slot->skipped;
+    snap->deadline_misses = slot->deadline_misses;
+    snap->vad_sum = slot->vad_sum;
+    memcpy(snap->stage_hist, slot->stage_hist, sizeof(snap->stage_hist));
+
+    atomic_thread_fence(memory_order_acquire);
+    unsigned int s2 = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    if (s1 == s2)
+      return true;
+  }
+  return false;
+}
+
+// Upper bound (us) of the bucket containing the given percentile.
+static double hist_percentile_us(const uint64_t *now, const uint64_t *prev,
+                                 double pct) {
+  uint64_t total = 0;
+  for (int b = 0; b < AUDX_TELEMETRY_HIST_BUCKETS; b++)
+    total += now[b] - prev[b];
+  if (total == 0)
+    return 0.0;
+
+  uint64_t target = (uint64_t)(total * pct);
+  uint64_t seen = 0;
+  for (int b = 0; b < AUDX_TELEMETRY_HIST_BUCKETS; b++) {
+    seen += now[b] - prev[b];
+    if (seen > target)
+      return (double)(1u << b);
+  }
+  return (double)(1u << (AUDX_TELEMETRY_HIST_BUCKETS - 1));
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <shm name | pid> [interval ms]\n", argv[0]);
+    return 1;
+  }
+
+  char name[64];
+  if (argv[1][0] == '/')
+    snprintf(name, sizeof(name), "%s", argv[1]);
+  else
+    snprintf(name, sizeof(name), "/audx-%s", argv[1]);
+  int interval_ms = argc > 2 ? atoi(argv[2]) : 1000;
+  if (interval_ms <= 0)
+    interval_ms = 1000;
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    fprintf(stderr, "Cannot open telemetry segment %s\n", name);
+    return 1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AudxTelemetryHeader)) {
+    fprintf(stderr, "Invalid telemetry segment %s\n", name);
+    close(fd);
+    return 1;
+  }
+
+  AudxTelemetryHeader *header =
+      mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (header == MAP_FAILED) {
+    fprintf(stderr, "Cannot map telemetry segment %s\n", name);
+    return 1;
+  }
+
+  if (header->magic != AUDX_TELEMETRY_MAGIC ||
+      header->version != AUDX_TELEMETRY_VERSION ||
+      header->stream_size != sizeof(AudxTelemetryStream) ||
+      header->header_size +
+              (uint64_t)header->max_streams * header->stream_size >
+          (uint64_t)st.st_size) {
+    fprintf(stderr, "Unsupported telemetry layout in %s\n", name);
+    return 1;
+  }
+
+  unsigned int max_streams = header->max_streams;
+  Snapshot *prev = calloc(max_streams, sizeof(Snapshot));
+  Snapshot *now = calloc(max_streams, sizeof(Snapshot));
+  if (!prev || !now)
+    return 1;
+
+  for (unsigned int i = 0; i < max_streams; i++)
+    if (!read_slot(audx_telemetry_stream_at(header, i), &prev[i]))
+      memset(&prev[i], 0, sizeof(prev[i]));
+
+  struct timespec interval = {interval_ms / 1000,
+                              (interval_ms % 1000) * 1000000L};
+  double seconds = interval_ms / 1000.0;
+
+  for (;;) {
+    nanosleep(&interval, NULL);
+
+    printf("\033[H\033[J");
+    printf("audx-top  pid %u  deadline %uus  streams created %llu  "
+           "destroyed %llu  untracked %llu\n\n",
+           header->pid, header->deadline_us,
+           (unsigned long long)atomic_load(&header->streams_created),
+           (unsigned long long)atomic_load(&header->streams_destroyed),
+           (unsigned long long)atomic_load(&header->streams_untracked));
+    printf("%8s %6s %8s %6s %6s %6s", "stream", "rate", "frames/s", "skip/s",
+           "miss/s", "vad");
+    for (int s = 0; s < AUDX_TELEMETRY_STAGES; s++)
+      printf(" %8s", stage_names[s]);
+    printf("\n%45s", "");
+    for (int s = 0; s < AUDX_TELEMETRY_STAGES; s++)
+      printf(" %8s", "p99 us");
+    printf("\n");
+
+    for (unsigned int i = 0; i < max_streams; i++) {
+      Snapshot *n = &now[i];
+      Snapshot *p = &prev[i];
+      if (!read_slot(audx_telemetry_stream_at(header, i), n)) {
+        // Keep the last good snapshot to diff against once it recovers
+        *n = *p;
+        if (p->live)
+          printf("%8llu", (unsigned long long)p->stream_id);
+        else
+          printf("%8s", "-");
+        printf(" %6s  stale: slot %u stuck mid-update\n", "", i);
+        continue;
+      }
+      if (!n->live)
+        continue;
+
+      // A reused slot starts a new stream; diff against zero.
+      if (p->stream_id != n->stream_id)
+        memset(p, 0, sizeof(*p));
+
+      uint64_t frames = n->frames - p->frames;
+      double vad = frames ? (n->vad_sum - p->vad_sum) / frames : 0.0;
+      printf("%8llu %6u %8.1f %6.1f %6.1f %6.3f",
+             (unsigned long long)n->stream_id, n->in_rate, frames / seconds,
+             (n->skipped - p->skipped) / seconds,
+             (n->deadline_misses - p->deadline_misses) / seconds, vad);
+      for (int s = 0; s < AUDX_TELEMETRY_STAGES; s++)
+        printf(" %8.0f",
+               hist_percentile_us(n->stage_hist[s], p->stage_hist[s], 0.99));
+      printf("\n");
+    }
+    fflush(stdout);
+
+    Snapshot *tmp = prev;
+    prev = now;
+    now = tmp;
+  }
+
+  return 0;
+}